@@ -0,0 +1,20 @@
+// Asteroid Style Game: The counting allocator, for the command-line programs.
+// Copyright (c) 2021 Darth Spectra
+#include <stdlib.h>
+#include <new>
+#include "Allocs.h"
+
+std::atomic<long> Asteroid::Allocs(0);
+
+// The global operator new, counting each allocation, and making it with malloc().
+// The array and sized forms are defined as well, so that every allocation is counted, and every deallocation is matched to malloc().
+void *operator new(size_t Size) {
+   Asteroid::Allocs++;
+   void *Mem = malloc(Size > 0? Size: 1); if (Mem == nullptr) throw std::bad_alloc();
+   return Mem;
+}
+void *operator new[](size_t Size) { return operator new(Size); }
+void operator delete(void *Mem) noexcept { free(Mem); }
+void operator delete[](void *Mem) noexcept { free(Mem); }
+void operator delete(void *Mem, size_t) noexcept { free(Mem); }
+void operator delete[](void *Mem, size_t) noexcept { free(Mem); }
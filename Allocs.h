@@ -0,0 +1,15 @@
+#ifndef OnceOnlyAllocs_h
+#define OnceOnlyAllocs_h
+
+// Asteroid Style Game: The counting allocator, for the command-line programs.
+// Copyright (c) 2021 Darth Spectra
+#include <atomic>
+
+namespace Asteroid {
+// The number of heap allocations made so far, by the global operator new (Allocs.cpp), which the programs that link Allocs.cpp have in place of the library's;
+// it is used to show that the engine's ticks make none once the game has settled down.
+// The count is atomic, since the engine may be run on a thread of its own.
+extern std::atomic<long> Allocs;
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -1,13 +1,20 @@
 // Asteroid Style Game: The driver program.
 // Copyright (c) 2009 Andy Thomas, (c) 2016-2018 Darth Ninja, (c) 2021 Darth Spectra
+#include <string.h>
 #include <QApplication>
 #include "Arena.h"
+#include "Trace.h"
 
 int main(int AC, char **AV) {
    try {
       QApplication App(AC, AV);
+   // -trace File: write a Chrome trace-event file of the game's polls, paints and sounds and the engine's ticks, until the game is closed.
+      for (int A = 1; A + 1 < AC; A++)
+         if (strcmp(AV[A], "-trace") == 0 && Asteroid::Trace::Start(AV[A + 1])) Asteroid::Trace::NameThread("game");
       QPixmap PixMap(":/Artwork.bmp");
       Arena MainWin; MainWin.show();
-      return App.exec();
+      int Status = App.exec();
+      Asteroid::Trace::Stop();
+      return Status;
    } catch(...) { return -1; }
 }
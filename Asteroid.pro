@@ -36,6 +36,15 @@ INCLUDEPATH = .
 ## Defines:
 win32:DEFINES *= WINDOWS WIN32 UNICODE NO_DEBUG
 #debug:DEFINES *= _DEBUG
+## Make with "qmake CONFIG+=profile" to compile in the profiler (Profile.h), for the engine and the programs alike.
+profile:DEFINES *= PROFILE
+
+## Libraries:
+## The game engine is built by Engine.pro, which should be made first.
+LIBS += -L. -lAsteroidEngine
+unix:LIBS += -lpthread # For the trace recorder's flusher thread and the simulation thread (Sim.h).
+win32-msvc*:PRE_TARGETDEPS += AsteroidEngine.lib
+else:PRE_TARGETDEPS += libAsteroidEngine.a
 
 ## Resources:
 RESOURCES = Image.qrc
@@ -52,15 +61,11 @@ release:MOC_DIR = Temp
 ## Header Files:
 HEADERS += About.h
 HEADERS += Arena.h
-HEADERS += Engine.h
 HEADERS += Game.h
-HEADERS += Objects.h
 HEADERS += Version.h
 
 ## Source Files:
 SOURCES += About.cpp
 SOURCES += Arena.cpp
 SOURCES += Asteroid.cpp
-SOURCES += Engine.cpp
 SOURCES += Game.cpp
-SOURCES += Objects.cpp
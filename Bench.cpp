@@ -0,0 +1,342 @@
+// Asteroid Style Game: The engine benchmarks.
+// Copyright (c) 2021 Darth Spectra
+// Time the motion kernels over large crowds of objects, and check that each gives the same result as the plain C++ kernel;
+// then time the engine's state tick, phase by phase, over synthetic rosters of 100 to 100000 objects, and over demo runs,
+// and the engine's snapshots, saved and restored, over the same rosters.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <complex>
+#include <vector>
+#include "Allocs.h"
+#include "Engine.h"
+#include "Kernel.h"
+#include "Snapshot.h"
+
+using namespace std;
+using namespace Asteroid;
+
+typedef chrono::steady_clock Clock;
+
+static void Usage(const char *App) {
+   fprintf(stderr,
+      "Usage: %s [-kernels | -engine] [-json] [-updates N] [-work N] [-ticks N] [-seed N] [-load File]\n"
+      "\t-kernels\tRun only the motion kernel benchmarks.\n"
+      "\t-engine\tRun only the engine benchmarks.\n"
+      "\t-json\tReport each result as a line of JSON, rather than as a table.\n"
+      "\t-updates N\tThe number of object updates to time, for each crowd size and kernel (default 50000000).\n"
+      "\t-work N\tThe number of object ticks to time, for each synthetic roster size (default 5000000).\n"
+      "\t-ticks N\tThe number of engine ticks in the demo run (default 20000).\n"
+      "\t-seed N\tThe random number seed for the crowds, rosters and demo run (default 1).\n"
+      "\t-load File\tRun the demo on from the snapshot in File (as saved by AsteroidSim -save), rather than from the start.\n"
+      "Each kernel moves and wraps crowds of 1000, 10000 and 100000 objects over the default play area.\n"
+      "The engine's state tick is timed phase by phase over rosters of 100, 1000, 10000 and 100000 objects,\n"
+      "on a play area scaled to keep the crowding as it is in a game, then as a whole over a demo run from BegDemo().\n"
+      "Snapshots of the engine are saved and restored over the same rosters, and checked to give back the same state;\n"
+      "snapshots corrupted in the fields that the engine indexes by are checked to be turned down.\n",
+      App
+   );
+}
+
+// A crowd of N objects, scattered over the play area and its Kuypier margin; about one in eight is held to the screen.
+struct Crowd {
+   vector<double> X, Y, DX, DY, Kuyp;
+   Crowd(size_t N, uint64_t Seed, double Xs, double Ys, double KX, double KY): X(N), Y(N), DX(N), DY(N), Kuyp(N) {
+      Random Rand(Seed);
+      for (size_t n = 0; n < N; n++) {
+         double R[5]; Rand.Fill(R, 5);
+         Kuyp[n] = R[4] < 0.125? 0.0: 1.0;
+         X[n] = R[0]*(Xs + 2.0*KX*Kuyp[n]) - KX*Kuyp[n], Y[n] = R[1]*(Ys + 2.0*KY*Kuyp[n]) - KY*Kuyp[n];
+         DX[n] = MaxShipSpeed*(2.0*R[2] - 1.0), DY[n] = MaxShipSpeed*(2.0*R[3] - 1.0);
+      }
+   }
+// A fingerprint of the positions, which must match across kernels.
+   double Sum() const {
+      double S = 0.0;
+      for (size_t n = 0; n < X.size(); n++) S += X[n]*(n%7 + 1) + Y[n]*(n%5 + 1);
+      return S;
+   }
+};
+
+// The way it was done before the kernels: one object at a time, rebuilding ObjPos values with branches.
+static double RunObjPos(size_t N, long Reps, uint64_t Seed, double Xs, double Ys, double KX, double KY, double *SumP) {
+   Crowd C(N, Seed, Xs, Ys, KX, KY);
+   vector<ObjPos> Pos(N), Dir(N);
+   for (size_t n = 0; n < N; n++) Pos[n] = ObjPos(C.X[n], C.Y[n]), Dir[n] = ObjPos(C.DX[n], C.DY[n]);
+   Clock::time_point T0 = Clock::now();
+   for (long R = 0; R < Reps; R++) {
+      for (size_t n = 0; n < N; n++) Pos[n] += Dir[n];
+      for (size_t n = 0; n < N; n++) {
+         double X = C.Kuyp[n]*KX, Y = C.Kuyp[n]*KY;
+         ObjPos P(Pos[n]);
+         if (P.real() < -X) P = ObjPos(Xs + X, P.imag());
+         if (P.imag() < -Y) P = ObjPos(P.real(), Ys + Y);
+         if (P.real() > Xs + X) P = ObjPos(-X, P.imag());
+         if (P.imag() > Ys + Y) P = ObjPos(P.real(), -Y);
+         Pos[n] = P;
+      }
+   }
+   double Secs = chrono::duration<double>(Clock::now() - T0).count();
+   for (size_t n = 0; n < N; n++) C.X[n] = Pos[n].real(), C.Y[n] = Pos[n].imag();
+   *SumP = C.Sum();
+   return Secs;
+}
+
+static double RunKernel(KernelT K, size_t N, long Reps, uint64_t Seed, double Xs, double Ys, double KX, double KY, double *SumP) {
+   Crowd C(N, Seed, Xs, Ys, KX, KY);
+   SetKernel(K);
+   Clock::time_point T0 = Clock::now();
+   for (long R = 0; R < Reps; R++)
+      Integrate(C.X.data(), C.Y.data(), C.DX.data(), C.DY.data(), N),
+      Wrap(C.X.data(), C.Y.data(), C.Kuyp.data(), N, Xs, Ys, KX, KY);
+   double Secs = chrono::duration<double>(Clock::now() - T0).count();
+   *SumP = C.Sum();
+   return Secs;
+}
+
+// The motion kernel benchmarks; tell whether every kernel gave the same result.
+static bool RunKernels(long Updates, uint64_t Seed, bool Json) {
+   const double Xs = 535, Ys = 400, KX = (int)Xs/KuyperSize, KY = (int)Ys/KuyperSize;
+   const size_t Sizes[] = { 1000, 10000, 100000 };
+   KernelT Best = BestKernel();
+   if (!Json)
+      printf("motion kernels (integrate and wrap); the best on this processor is %s\n", KernelName(Best)),
+      printf("%8s %-8s %12s %9s %s\n", "objects", "kernel", "ns/object", "speedup", "result");
+   bool Ok = true;
+   for (size_t S = 0; S < sizeof Sizes/sizeof Sizes[0]; S++) {
+      size_t N = Sizes[S]; long Reps = Updates/(long)N; if (Reps < 1) Reps = 1;
+      double Scale = 1.0e9/((double)N*Reps);
+      double Sum0, Secs0 = RunObjPos(N, Reps, Seed, Xs, Ys, KX, KY, &Sum0);
+      if (Json) printf("{\"bench\":\"kernel\",\"objects\":%zu,\"kernel\":\"objpos\",\"ns_per_object\":%.3f}\n", N, Secs0*Scale);
+      else printf("%8zu %-8s %12.3f %9s %s\n", N, "objpos", Secs0*Scale, "-", "reference");
+      double SumS = Sum0;
+      for (int K = ScalarK; K < KernelN; K++) {
+         const char *Name = KernelName((KernelT)K);
+         if (!HasKernel((KernelT)K)) {
+            if (!Json) printf("%8zu %-8s %12s %9s %s\n", N, Name, "-", "-", "unsupported");
+            continue;
+         }
+         double Sum, Secs = RunKernel((KernelT)K, N, Reps, Seed, Xs, Ys, KX, KY, &Sum);
+         if (K == ScalarK) SumS = Sum;
+         bool Same = Sum == SumS && Sum == Sum0; Ok = Ok && Same;
+         double Speedup = Secs > 0.0? Secs0/Secs: 0.0;
+         if (Json)
+            printf(
+               "{\"bench\":\"kernel\",\"objects\":%zu,\"kernel\":\"%s\",\"ns_per_object\":%.3f,\"speedup\":%.3f,\"same\":%s}\n",
+               N, Name, Secs*Scale, Speedup, Same? "true": "false"
+            );
+         else printf("%8zu %-8s %12.3f %8.2fx %s\n", N, Name, Secs*Scale, Speedup, Same? "same": "DIFFERENT");
+      }
+   }
+   SetKernel(Best);
+   return Ok;
+}
+
+// The engine benchmarks
+// ─────────────────────
+// The phases of the engine's state tick, in the order that Engine::_StateTick() calls them.
+enum PhaseT { SweepP, MoveP, TickP, CollideP, StrikeP, SpawnP, WrapP, PhaseN };
+static const char *const PhaseName[PhaseN] = { "sweep", "move", "tick", "collide", "strike", "spawn", "wrap" };
+
+// The number of ticks each synthetic roster is run for, before it is built afresh.
+// A roster thins out and changes its make-up as its rocks break up, so the runs are kept short, to time much the same roster each time.
+const int RosterTicks = 10;
+
+// The synthetic rosters, and the state tick taken apart, as a friend of the engine.
+namespace Asteroid {
+class Bench {
+public:
+// Fill an empty engine with a roster of N objects, scattered with random speeds over a play area scaled to N,
+// so that the objects are about as crowded as in a game (some 20 to the default play area): mostly rocks, with some lances and aliens.
+   static void Populate(Engine &E, size_t N, uint64_t Seed) {
+      double Scale = sqrt((double)N/20.0); if (Scale < 1.0) Scale = 1.0;
+      E.SetSeed(Seed), E.SetPlayDims((int)(535*Scale), (int)(400*Scale)), E.SetLevel(0.5);
+      Random &Rand = E.GetRandom();
+      double Xs = E._Xs, Ys = E._Ys;
+      for (size_t n = 0; n < N; n++) {
+         double R[5]; Rand.Fill(R, 5);
+         TypeT T = R[4] < 0.005? AlienOT: R[4] < 0.1? LanceOT: R[4] < 0.4? BoulderOT: R[4] < 0.7? StoneOT: PebbleOT;
+         double Speed = T == LanceOT? MaxShipSpeed: RockSpeedMult*MaxShipSpeed/2.0;
+         E.AddThing(T, ObjPos(R[0]*Xs, R[1]*Ys), ObjPos(Speed*(2.0*R[2] - 1.0), Speed*(2.0*R[3] - 1.0)));
+      }
+   }
+// One state tick, as Engine::_StateTick() does it, adding the time taken by each phase, in nanoseconds, to Ns.
+   static void Step(Engine &E, double Ns[PhaseN]) {
+      if (++E._Ticks >= 0x7fffffff) E._Ticks = 1000;
+      Clock::time_point T0 = Clock::now(), T1;
+      size_t N = E._Sweep();
+      T1 = Clock::now(), Ns[SweepP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._Move(N);
+      T1 = Clock::now(), Ns[MoveP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._TickAll(N);
+      T1 = Clock::now(), Ns[TickP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._Collide(N);
+      T1 = Clock::now(), Ns[CollideP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._Strike(N);
+      T1 = Clock::now(), Ns[StrikeP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._Spawn();
+      T1 = Clock::now(), Ns[SpawnP] += chrono::duration<double, nano>(T1 - T0).count(), T0 = T1;
+      E._WrapAll();
+      T1 = Clock::now(), Ns[WrapP] += chrono::duration<double, nano>(T1 - T0).count();
+   }
+};
+}
+
+// Report one engine result: its time per tick and per object tick, its heap allocations per tick,
+// and, for a synthetic roster, the time per tick taken by each phase.
+static void Report(bool Json, const char *Roster, size_t N, long Ticks, double ObjTicks, double Ns, long TickAllocs, const double *PhaseNs) {
+   double PerTick = Ticks > 0? Ns/Ticks: 0.0, PerObj = ObjTicks > 0.0? Ns/ObjTicks: 0.0, AllocsPerTick = Ticks > 0? (double)TickAllocs/Ticks: 0.0;
+   if (Json) {
+      printf(
+         "{\"bench\":\"engine\",\"roster\":\"%s\",\"objects\":%zu,\"ticks\":%ld,\"ns_per_tick\":%.1f,\"ns_per_object\":%.3f,\"allocs_per_tick\":%.4f",
+         Roster, N, Ticks, PerTick, PerObj, AllocsPerTick
+      );
+      if (PhaseNs != nullptr) {
+         printf(",\"phases_ns_per_tick\":{");
+         for (int P = 0; P < PhaseN; P++) printf("%s\"%s\":%.1f", P > 0? ",": "", PhaseName[P], PhaseNs[P]/Ticks);
+         printf("}");
+      }
+      printf("}\n");
+   } else {
+      printf("%-9s %8zu %8ld %12.1f %10.3f %9.4f", Roster, N, Ticks, PerTick, PerObj, AllocsPerTick);
+      if (PhaseNs != nullptr) for (int P = 0; P < PhaseN; P++) printf(" %9.1f", PhaseNs[P]/Ticks);
+      printf("\n");
+   }
+}
+
+// The engine benchmarks: the synthetic rosters, phase by phase, then the demo run, as a whole, from the start or from the snapshot Start.
+static void RunEngine(long Work, long DemoTicks, uint64_t Seed, bool Json, const Snapshot *Start) {
+   const size_t Sizes[] = { 100, 1000, 10000, 100000 };
+   if (!Json) {
+      printf("engine state tick; ns/object is per object in the roster, per tick; the phase columns are in ns/tick\n");
+      printf("%-9s %8s %8s %12s %10s %9s", "roster", "objects", "ticks", "ns/tick", "ns/object", "allocs");
+      for (int P = 0; P < PhaseN; P++) printf(" %9s", PhaseName[P]);
+      printf("\n");
+   }
+   for (size_t S = 0; S < sizeof Sizes/sizeof Sizes[0]; S++) {
+      size_t N = Sizes[S]; long Reps = Work/((long)N*RosterTicks); if (Reps < 1) Reps = 1;
+      double PhaseNs[PhaseN] = { 0.0 }, ObjTicks = 0.0; long TickAllocs = 0;
+      for (long R = 0; R < Reps; R++) {
+         Engine E; Bench::Populate(E, N, Seed);
+         for (int T = 0; T < RosterTicks; T++) {
+            ObjTicks += E.ObjN();
+            long Allocs0 = Allocs;
+            Bench::Step(E, PhaseNs);
+            TickAllocs += Allocs - Allocs0;
+         }
+      }
+      double Ns = 0.0; for (int P = 0; P < PhaseN; P++) Ns += PhaseNs[P];
+      Report(Json, "synthetic", N, Reps*RosterTicks, ObjTicks, Ns, TickAllocs, PhaseNs);
+   }
+// The demo, restarted whenever it ends, as AsteroidSim runs it, with the engine's own Tick().
+   Engine E; E.SetSeed(Seed);
+   if (Start != nullptr) Start->Give(E);
+   double ObjTicks = 0.0, Ns = 0.0; long TickAllocs = 0; size_t Peak = 0;
+   for (long T = 0; T < DemoTicks; T++) {
+      if (E.EndGame()) E.BegDemo(20, 10);
+      size_t N = E.ObjN(); ObjTicks += N; if (N > Peak) Peak = N;
+      long Allocs0 = Allocs;
+      Clock::time_point T0 = Clock::now();
+      E.Tick();
+      Ns += chrono::duration<double, nano>(Clock::now() - T0).count();
+      TickAllocs += Allocs - Allocs0;
+   }
+   Report(Json, Start != nullptr? "snapshot": "demo", Peak, DemoTicks, ObjTicks, Ns, TickAllocs, nullptr);
+}
+
+// The corruptions tried on a snapshot, each of which Engine::Restore() should turn down.
+enum CorruptT { OrientCO = 0, SpinCO, PtsCO, RandCO, PosCO, RadiusCO, CorruptN };
+static const char *const CorruptName[CorruptN] = { "orient", "spin", "font", "rand", "position", "radius" };
+
+// Save a snapshot of a demo game, once its ship is in play, corrupt it in each of the ways above in turn, and tell whether every one was turned down,
+// with the engine restored into left as it was.
+static bool RunBadSnapshots(uint64_t Seed, bool Json) {
+   Engine E; E.SetSeed(Seed), E.SetPlayDims(535, 400), E.SetLevel(0.5), E.BegDemo(20, 10);
+   for (int T = 0; T < 5000 && E.Census(ShipOT) == 0; T++) E.Tick();
+   vector<uint64_t> Good((E.SaveSize() + 7)/8), Bad(Good.size());
+   size_t Bytes = E.Save(Good.data(), 8*Good.size());
+   const SnapHeadT &H = *reinterpret_cast<const SnapHeadT *>(Good.data());
+   SnapLayout L(H.Objs, H.Handles, H.Sparks);
+   const unsigned char *Type = reinterpret_cast<const unsigned char *>(Good.data()) + L.Type;
+   size_t Ship = 0; while (Ship < H.Objs && Type[Ship] != ShipOT) Ship++;
+   if (Ship == H.Objs) { fprintf(stderr, "The demo has no ship, to corrupt the snapshot of.\n"); return false; }
+   Engine Copy; uint64_t Sum = Copy.Checksum(); int Turned = 0;
+   for (int C = 0; C < CorruptN; C++) {
+      Bad = Good;
+      char *B = reinterpret_cast<char *>(Bad.data());
+      SnapHeadT &BH = *reinterpret_cast<SnapHeadT *>(B); SnapThingT &Sh = reinterpret_cast<SnapThingT *>(B + L.Things)[Ship];
+      switch (C) {
+         case OrientCO: Sh.Orient = -400000000, Sh.Spin = 0; break;
+         case SpinCO: Sh.Spin = 2; break;
+         case PtsCO: Sh.Pts = FontN; break;
+         case RandCO: for (int n = 0; n < 4; n++) BH.Rand[n] = 0; break;
+         case PosCO: reinterpret_cast<double *>(B + L.X)[Ship] = NAN; break;
+         case RadiusCO: reinterpret_cast<double *>(B + L.Radius)[Ship] = INFINITY; break;
+      }
+      bool Took = Copy.Restore(Bad.data(), Bytes), Kept = Copy.Checksum() == Sum;
+      if (!Took && Kept) Turned++;
+      if (Json) printf("{\"bench\":\"bad_snapshot\",\"corrupt\":\"%s\",\"rejected\":%s}\n", CorruptName[C], !Took && Kept? "true": "false");
+   }
+   if (!Json) printf("corrupted snapshots turned down: %d of %d\n", Turned, (int)CorruptN);
+   return Turned == CorruptN;
+}
+
+// The snapshot benchmarks: save and restore a snapshot of each synthetic roster, over and over, with the snapshot's buffer kept from one to the next;
+// tell whether every restore gave back the state that was saved, by the engine's checksum.
+static bool RunSnapshots(long Work, uint64_t Seed, bool Json) {
+   const size_t Sizes[] = { 100, 1000, 10000, 100000 };
+   if (!Json) printf("engine snapshots\n%-9s %8s %10s %10s %10s %9s %s\n", "roster", "objects", "bytes", "save us", "restore us", "allocs", "result");
+   bool Ok = true;
+   for (size_t S = 0; S < sizeof Sizes/sizeof Sizes[0]; S++) {
+      size_t N = Sizes[S]; long Reps = Work/((long)N*RosterTicks); if (Reps < 1) Reps = 1;
+      Engine E; Bench::Populate(E, N, Seed);
+      Engine Copy; Snapshot Snap; Snap.Take(E), Snap.Give(Copy); // Grow the buffers up front.
+      long Allocs0 = Allocs;
+      Clock::time_point T0 = Clock::now();
+      for (long R = 0; R < Reps; R++) Snap.Take(E);
+      Clock::time_point T1 = Clock::now();
+      for (long R = 0; R < Reps; R++) Snap.Give(Copy);
+      Clock::time_point T2 = Clock::now();
+      double Saves = 1.0e6*chrono::duration<double>(T1 - T0).count()/Reps, Restores = 1.0e6*chrono::duration<double>(T2 - T1).count()/Reps;
+      double AllocsPer = (double)(Allocs - Allocs0)/(2*Reps);
+      bool Same = Copy.Checksum() == E.Checksum(); Ok = Ok && Same;
+      if (Json)
+         printf(
+            "{\"bench\":\"snapshot\",\"objects\":%zu,\"bytes\":%zu,\"save_us\":%.3f,\"restore_us\":%.3f,\"allocs\":%.4f,\"same\":%s}\n",
+            N, Snap.Size(), Saves, Restores, AllocsPer, Same? "true": "false"
+         );
+      else printf("%-9s %8zu %10zu %10.3f %10.3f %9.4f %s\n", "synthetic", N, Snap.Size(), Saves, Restores, AllocsPer, Same? "same": "DIFFERENT");
+   }
+   return RunBadSnapshots(Seed, Json) && Ok;
+}
+
+int main(int AC, char **AV) {
+   bool Kernels = true, Engines = true, Json = false;
+   long Updates = 50000000, Work = 5000000, DemoTicks = 20000; uint64_t Seed = 1;
+   const char *LoadFrom = nullptr;
+   for (int A = 1; A < AC; A++) {
+      const char *Arg = AV[A]; bool More = A + 1 < AC;
+      if (strcmp(Arg, "-kernels") == 0) Kernels = true, Engines = false;
+      else if (strcmp(Arg, "-engine") == 0) Kernels = false, Engines = true;
+      else if (strcmp(Arg, "-json") == 0) Json = true;
+      else if (strcmp(Arg, "-updates") == 0 && More) Updates = atol(AV[++A]);
+      else if (strcmp(Arg, "-work") == 0 && More) Work = atol(AV[++A]);
+      else if (strcmp(Arg, "-ticks") == 0 && More) DemoTicks = atol(AV[++A]);
+      else if (strcmp(Arg, "-seed") == 0 && More) Seed = strtoull(AV[++A], nullptr, 0);
+      else if (strcmp(Arg, "-load") == 0 && More) LoadFrom = AV[++A];
+      else { Usage(AV[0]); return 1; }
+   }
+   Snapshot Start;
+   if (LoadFrom != nullptr && !Start.Read(LoadFrom)) { fprintf(stderr, "Cannot read the snapshot in %s.\n", LoadFrom); return 1; }
+   bool Ok = true;
+   if (Kernels) Ok = RunKernels(Updates, Seed, Json);
+   if (Kernels && Engines && !Json) printf("\n");
+   if (Engines) {
+      RunEngine(Work, DemoTicks, Seed, Json, LoadFrom != nullptr? &Start: nullptr);
+      if (!Json) printf("\n");
+      Ok = RunSnapshots(Work, Seed, Json) && Ok;
+   }
+   return Ok? 0: 2;
+}
@@ -0,0 +1,41 @@
+## Asteroid Style Game, QT-based makefile for the engine benchmarks
+## (c) 2021 Darth Spectra (Lydia Marie Williamson)
+
+## A command-line program that times the engine's kernels over large crowds of objects.
+## Build Engine.pro first.
+## See Asteroid.pro for notes on the QMake variables.
+
+## Configuration
+## Setup:
+TEMPLATE = app
+CONFIG += console warn_on release
+CONFIG -= qt app_bundle
+
+## Paths:
+TARGET = AsteroidBench
+DESTDIR = .
+INCLUDEPATH = .
+MAKEFILE = Makefile.Bench
+
+## Defines:
+win32:DEFINES *= WINDOWS WIN32 UNICODE NO_DEBUG
+#debug:DEFINES *= _DEBUG
+## Make with "qmake CONFIG+=profile" to compile in the profiler (Profile.h), for the engine and the programs alike.
+profile:DEFINES *= PROFILE
+
+## Libraries:
+LIBS += -L. -lAsteroidEngine
+unix:LIBS += -lpthread # For the trace recorder's flusher thread.
+win32-msvc*:PRE_TARGETDEPS += AsteroidEngine.lib
+else:PRE_TARGETDEPS += libAsteroidEngine.a
+
+## Objects and Temp files:
+debug:OBJECTS_DIR = Temp
+release:OBJECTS_DIR = Temp
+
+## Header Files:
+HEADERS += Allocs.h
+
+## Source Files:
+SOURCES += Bench.cpp
+SOURCES += Allocs.cpp
@@ -1,38 +1,83 @@
 // Asteroid Style Game: The engine for holding and updating the game artifacts.
 // Copyright (c) 2009 Big Angry Dog, (c) 2016-2018 Darth Ninja, (c) 2021 Darth Spectra
 #include <math.h>
-#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <algorithm>
 #include "Engine.h"
+#include "Kernel.h"
+#include "Profile.h"
+#include "Trace.h"
+#include "Traits.h"
 
 using namespace std;
 using namespace Asteroid;
 
+#ifdef M_PI
+static const double TwoPi = 2.0*M_PI; // 2π
+#else
+static const double TwoPi = 6.28318530717958648;
+#endif
+
 // class Engine: private methods
 // ─────────────────────────────
+// The storage slot size: enough for any of the objects.
+static constexpr size_t MaxOf(size_t A, size_t B) { return A > B? A: B; }
+static const size_t ThingSize = MaxOf(
+   MaxOf(MaxOf(sizeof(Boulder), sizeof(Stone)), MaxOf(sizeof(Pebble), sizeof(Ship))),
+   MaxOf(MaxOf(sizeof(Alien), sizeof(Lance)), sizeof(Label))
+);
+
 // Empty the game of objects.
 void Engine::_Empty(bool Now) {
-   size_t N = _Objects.size();
-   if (Now) { // Kill all life in space.
-      for (size_t n = 0; n < N; n++) delete _Objects[n];
-      _Objects.clear();
-   } else // Condemn them for deletion on the next tick.
-      for (size_t n = 0; n < N; n++) _Objects[n]->SetDead();
+   size_t N = _Store.Size();
+   if (Now) // Kill all life in space: the objects hold nothing that needs to be freed, so their storage is released wholesale.
+   // The handle generations carry on from where they were, so that any handles still held for these objects go stale.
+      _Store.Clear(), _Things.Reset(), _Handles.clear(), _FreeHandle = -1, _ResetCensus();
+   else // Condemn them for deletion on the next tick.
+      for (size_t n = 0; n < N; n++) _Store.Obj[n]->SetDead();
+// The particles are only for show, so they go at once, either way.
+   _Sparks.Clear();
+}
+
+// Destroy the object, revoke its handle and return its storage to the pool.
+void Engine::_Free(Thing *Obj) {
+   _Census[_Store.Type[Obj->_Row]]--;
+   HandleT &H = _Handles[Obj->_Id.Ix];
+   H.Obj = nullptr, H.Gen = 0, H.Next = _FreeHandle, _FreeHandle = Obj->_Id.Ix;
+   Obj->~Thing(), _Things.Put(Obj);
 }
 
-// Collision-test for A and B: are both alive, with positive mass and closer to each other than their respective sizes?
-bool Engine::_Crash(const Thing &A, const Thing &B) const {
-   return !A.GetDead() && !B.GetDead() && A.Mass() > 0 && B.Mass() > 0 && abs(A._Pos - B._Pos) <= A.GetRadius() + B.GetRadius();
+// Issue a handle for the object: reuse a free entry of the table, if there are any, under a new generation.
+Handle Engine::_Issue(Thing *Obj) {
+   if (++_Gen == 0) _Gen = 1; // Generation 0 is reserved for the null handle.
+   int Ix = _FreeHandle;
+   if (Ix >= 0) _FreeHandle = _Handles[Ix].Next;
+   else Ix = _Handles.size(), _Handles.push_back(HandleT());
+   HandleT &H = _Handles[Ix]; H.Obj = Obj, H.Gen = _Gen, H.Next = -1;
+   return Obj->_Id = Handle(Ix, _Gen);
 }
 
-// Rebound these objects.
-void Engine::_Boing(const Thing &A, const Thing &B, ObjPos &PosA, ObjPos &PosB) const {
-// Intentionally copy the directions, as the result reference may be object directions.
-   ObjPos DirA(A._Dir); double MassA(A.Mass());
-   ObjPos DirB(B._Dir); double MassB(B.Mass());
+// Collision-test for the objects in rows A and B: are both alive, with positive mass and closer to each other than their respective sizes?
+bool Engine::_Crash(size_t A, size_t B) const {
+   const Store &S = _Store;
+   return
+      !S.Dead[A] && !S.Dead[B] && S.Mass[A] > 0 && S.Mass[B] > 0 &&
+      abs(ObjPos(S.X[A] - S.X[B], S.Y[A] - S.Y[B])) <= S.Radius[A] + S.Radius[B];
+}
+
+// Rebound the objects in rows A and B, if they are closing in on each other.
+void Engine::_Boing(size_t A, size_t B) {
+   Store &S = _Store;
+   ObjPos DirA(S.DX[A], S.DY[A]); double MassA(S.Mass[A]);
+   ObjPos DirB(S.DX[B], S.DY[B]); double MassB(S.Mass[B]);
+   ObjPos Gap(S.X[A] - S.X[B], S.Y[A] - S.Y[B]);
    double Mass(MassA + MassB);
-   if (Mass > 0.0 && abs(A._Pos - B._Pos) > abs(A._Pos - B._Pos + 0.1*(DirA - DirB)))
-      PosA = (DirA*(MassA - MassB) + 2.0*DirB*MassB)/Mass, Thing::LimitAbs(PosA, MaxShipSpeed),
-      PosB = (DirB*(MassB - MassA) + 2.0*DirA*MassA)/Mass, Thing::LimitAbs(PosB, MaxShipSpeed);
+   if (Mass > 0.0 && abs(Gap) > abs(Gap + 0.1*(DirA - DirB))) {
+      ObjPos NewA((DirA*(MassA - MassB) + 2.0*DirB*MassB)/Mass); Thing::LimitAbs(NewA, MaxShipSpeed);
+      ObjPos NewB((DirB*(MassB - MassA) + 2.0*DirA*MassA)/Mass); Thing::LimitAbs(NewB, MaxShipSpeed);
+      S.DX[A] = NewA.real(), S.DY[A] = NewA.imag(), S.DX[B] = NewB.real(), S.DY[B] = NewB.imag();
+   }
 }
 
 #if 1
@@ -66,192 +111,528 @@ static char *ItoA(int N, char *Buf, int Base) {
 
 // Update Internal
 // ───────────────
-// Move the objects, check for collisions, handle rebounds and set the appropriate flags, in that order.
-void Engine::_StateTick() {
-// Increment the counter.
-   if (++_Ticks >= 0x7fffffff) _Ticks = 1000;
-// Set the sound flags to zero; they will be set back to true below, if required.
-   _BoomSnd = NoOT, _DiedSnd = false, _AlienSnd = false;
-// Free and remove objects which are now dead from the previous tick.
-   for (size_t N = 0; N < _Objects.size(); )
-      if (_Objects[N]->GetDead()) {
-         delete _Objects[N]; _Objects.erase(_Objects.begin() + N);
-      } else N++;
-// Hold the count, because other objects will be added as parts of explosions.
-   size_t N = _Objects.size();
-// Tick each object: get them each to do their thing in the next state tick.
-   for (size_t n = 0; n < N; n++) _Objects[n]->Tick();
-// Collisions: see who collided and sound out their explosions.
-// Note that the Tick() calls above may have added objects after the size N count, but this is OK.
-   for (size_t n0 = 0; n0 < N; n0++) for (size_t n1 = n0 + 1; n1 < N && !_Objects[n0]->GetDead(); n1++)
-   if (_Crash(*_Objects[n0], *_Objects[n1])) {
-   // When worlds collide!
-   // Set rebound in motion.
-      _Boing(*_Objects[n0], *_Objects[n1], _Objects[n0]->_Dir, _Objects[n1]->_Dir);
-   // Was this fatal?
-      bool Lethal0 = _Objects[n0]->Lethal(*_Objects[n1]), Lethal1 = _Objects[n1]->Lethal(*_Objects[n0]);
-   // Blow them up.
-      if (Lethal0) _Objects[n0]->Boom();
-      if (Lethal1) _Objects[n1]->Boom();
-      if (Lethal0 || Lethal1) {
-      // Something blew up: was it a rock?
-      // Set the largest explosion sound, if true.
-         if (Lethal0 && _Objects[n0]->Rocky()) _BoomSnd = _Objects[n0]->Type();
-         if (Lethal1 && _Objects[n1]->Rocky() && (_BoomSnd == NoOT || _Objects[n1]->Mass() > _Objects[n0]->Mass()))
-            _BoomSnd = _Objects[n1]->Type();
-      // Did our ship blow up yet?
-         if ((Lethal0 && _Objects[n0]->Type() == ShipOT) || (Lethal1 && _Objects[n1]->Type() == ShipOT))
-         // Oh dear, lost a ship.
-            _Lives--, _DiedSnd = true,
-         // Wait for another ship to arrive or time out at the end of the game.
-            _NewLifeWait = time(0) + RevivePause;
-      // Set the score and pointer to whatever object may have been shot.
-         int Sc = 0; Thing *Obj = nullptr;
-         if (Lethal1 && _Objects[n0]->Type() == LanceOT) {
-            Sc = _Objects[n1]->Score(); if (_Objects[n1]->Type() == AlienOT) Obj = _Objects[n1];
-         } else if (Lethal0 && _Objects[n1]->Type() == LanceOT) {
-            Sc = _Objects[n0]->Score(); if (_Objects[n0]->Type() == AlienOT) Obj = _Objects[n0];
-         }
-      // Have we shot an alien?
-         if (Obj != nullptr) {
-         // Alien kill: label it.
-            Thing *Lab = AddThing(LabelOT, Obj->_Pos, Obj->_Dir); Lab->SetPts(SmallLF);
-         // Alien sound.
-            _AlienSnd = true;
-         // Label an extra life or score.
-         // A score label generates a warning, when compiled under VC2005.
-         // This is OK.
-         //(@) Side note: itoa(), which was in the original, is not part of C++, and so has been replaced.
-            if (Thing::RandB()) _Lives++, Lab->SetCaption("EXTRA LIFE");
-            else {
-               char Cap[100]; ItoA(Sc, Cap, 10), Lab->SetCaption(Cap);
+// Collisions among the first N objects: see who collided and sound out their explosions.
+// Only pairs close enough to possibly touch are tested; these are taken from a grid over the play area and its Kuypier margin,
+// whose cells are as wide as the largest collision diameter, so that colliding pairs always lie in neighboring cells.
+// The pairs are tested in the same order as a full n0 < n1 scan would use, so that the rebounds, scores and sounds are unchanged.
+// The collision test itself does not wrap around the play area, so neither does the grid.
+// Transparent (zero-mass) types never enter the grid, and Lethal() is only asked of pairs that the type traits (Traits.h) allow to be fatal.
+void Engine::_Collide(size_t N) {
+   Profiled(CollidePR); Traced(CollidePR);
+// The store's columns are re-read through S on each use, rather than cached, since explosions add rows to it as we go.
+   Store &S = _Store;
+   _Solid.clear();
+   double MaxR = 0.0;
+   for (size_t n = 0; n < N; n++)
+      if (!S.Dead[n] && Traits[S.Type[n]].Solid) {
+         _Solid.push_back(n);
+         if (S.Radius[n] > MaxR) MaxR = S.Radius[n];
+      }
+   int X = _Xs/KuyperSize, Y = _Ys/KuyperSize;
+   _Near.Reset(-X, -Y, _Xs + X, _Ys + Y, 2.0*MaxR, N);
+   for (size_t s = 0; s < _Solid.size(); s++) _Near.Add(_Solid[s], ObjPos(S.X[_Solid[s]], S.Y[_Solid[s]]));
+   for (size_t s = 0; s < _Solid.size(); s++) {
+      size_t n0 = _Solid[s]; if (S.Dead[n0]) continue;
+   // The candidates which come after n0, in roster order.
+      _Pairs.clear(), _Near.Near(ObjPos(S.X[n0], S.Y[n0]), [this, n0](int n1) { if ((size_t)n1 > n0) _Pairs.push_back(n1); });
+      sort(_Pairs.begin(), _Pairs.end()), ProfileCount(PairsPR, _Pairs.size());
+      for (size_t p = 0; p < _Pairs.size() && !S.Dead[n0]; p++) {
+         size_t n1 = _Pairs[p];
+         if (_Crash(n0, n1)) {
+         // When worlds collide!
+         // Set rebound in motion.
+            _Boing(n0, n1);
+         // Was this fatal?
+            TypeT T0 = (TypeT)S.Type[n0], T1 = (TypeT)S.Type[n1];
+            bool Lethal0 = CanKill(T0, T1) && _Store.Obj[n0]->Lethal(*_Store.Obj[n1]);
+            bool Lethal1 = CanKill(T1, T0) && _Store.Obj[n1]->Lethal(*_Store.Obj[n0]);
+         // Blow them up.
+            if (Lethal0) _Store.Obj[n0]->Boom();
+            if (Lethal1) _Store.Obj[n1]->Boom();
+            if (Lethal0 || Lethal1) {
+            // Tell of the explosions.
+               if (Lethal0) Emit(BoomEV, T0, ObjPos(S.X[n0], S.Y[n0]));
+               if (Lethal1) Emit(BoomEV, T1, ObjPos(S.X[n1], S.Y[n1]));
+            // Did our ship blow up yet?
+               if ((Lethal0 && T0 == ShipOT) || (Lethal1 && T1 == ShipOT)) {
+               // Oh dear, lost a ship.
+                  size_t n = T0 == ShipOT? n0: n1;
+                  _Lives--, Emit(DiedEV, ShipOT, ObjPos(S.X[n], S.Y[n]));
+               // Wait for another ship to arrive or time out at the end of the game.
+                  _NewLifeWait = _Ticks + RevivePause*TickRate;
+               }
+            // Set the score and pointer to whatever object may have been shot.
+               int Sc = 0; Thing *Obj = nullptr, *Shot = nullptr;
+               if (Lethal1 && T0 == LanceOT) {
+                  Shot = _Store.Obj[n1], Sc = Shot->Score(); if (T1 == AlienOT) Obj = Shot;
+               } else if (Lethal0 && T1 == LanceOT) {
+                  Shot = _Store.Obj[n0], Sc = Shot->Score(); if (T0 == AlienOT) Obj = Shot;
+               }
+            // Have we shot an alien?
+               if (Obj != nullptr) {
+               // Alien kill: label it.
+                  Thing *Lab = AddThing(LabelOT, Obj->GetPos(), Obj->GetDir()); Lab->SetPts(SmallLF);
+               // Tell of the kill.
+                  Emit(AlienEV, AlienOT, Obj->GetPos());
+               // Label an extra life or score.
+               // A score label generates a warning, when compiled under VC2005.
+               // This is OK.
+               //(@) Side note: itoa(), which was in the original, is not part of C++, and so has been replaced.
+                  if (_Rand.RandB()) _Lives++, Lab->SetCaption("EXTRA LIFE"), Emit(ExtraLifeEV, AlienOT, Obj->GetPos());
+                  else {
+                     char Cap[100]; ItoA(Sc, Cap, 10), Lab->SetCaption(Cap);
+                  }
+               }
+            // Score the kill.
+               _Score += Sc;
+               if (Sc != 0) Emit(ScoreEV, Shot->Type(), Shot->GetPos(), Sc);
             }
          }
-      // Score the kill.
-         _Score += Sc;
       }
    }
+   ProfileTally(PairsPR);
+}
+
+// Zero the census, for a new game.
+void Engine::_ResetCensus() {
+   for (int T = 0; T < TypeN; T++) _Census[T] = 0, _PeakCensus[T] = 0;
+}
+
+// Index the threats to the aliens among the first N objects: the objects heavier than an alien, and the ship.
+// This is done once a tick, and only if there are any aliens, to be shared by them all, rather than each alien scanning the roster.
+// It is made over the play area and its Kuypier margin, as the collision grid is, but with a few large cells,
+// since there are few threats and each alien looks for only the nearest one.
+void Engine::_IndexThreats(size_t N) {
+   _HasThreats = false;
+   for (size_t n = 0; n < N && !_HasThreats; n++) _HasThreats = _Store.Type[n] == AlienOT;
+   if (!_HasThreats) return;
+   int X = _Xs/KuyperSize, Y = _Ys/KuyperSize;
+   _Threats.Reset(-X, -Y, _Xs + X, _Ys + Y, (_Xs > _Ys? _Xs: _Ys)/8.0, N);
+   for (size_t n = 0; n < N; n++) _IndexThreat(n);
+}
+
+// Add the object in row n to the threat index, if it is a threat to the aliens.
+void Engine::_IndexThreat(size_t n) {
+   if (Traits[_Store.Type[n]].Mass > Alien::TypeMass || _Store.Type[n] == ShipOT) _Threats.Add(n, ObjPos(_Store.X[n], _Store.Y[n]));
+}
+
+// The phases of the state tick
+// ─────────────────────────────
+// These are called in turn by _StateTick(), and are kept apart so that each may be timed on its own (Bench.cpp).
+// Free and remove objects which are now dead from the previous tick, and tell how many are left.
+// This is done in one pass, which closes up the roster behind the dead, so the survivors keep their order.
+size_t Engine::_Sweep() {
+   Profiled(SweepPR); Traced(SweepPR);
+   size_t Live = 0;
+   for (size_t n = 0; n < _Store.Size(); n++)
+      if (_Store.Dead[n]) _Free(_Store.Obj[n]); else { if (Live < n) _Store.Move(n, Live); Live++; }
+   _Store.Resize(Live);
+   return Live;
+}
+
+// Move each of the first N objects, all together in one pass through the position and velocity columns, then the particles;
+// any particles added later in the tick will first move on the next tick, just as the objects do.
+void Engine::_Move(size_t N) {
+   Profiled(MovePR); Traced(MovePR);
+   Integrate(_Store.X.data(), _Store.Y.data(), _Store.DX.data(), _Store.DY.data(), N);
+   _Sparks.Tick(_Ticks, _Xs, _Ys, _Xs/KuyperSize, _Ys/KuyperSize);
+}
+
+// Tick each of the first N objects: get them each to do their thing in the next state tick.
+// The aliens steer clear of the nearest threat, so the threats are indexed first;
+// any threats added by the objects ticked so far, such as the stones from a boulder that has burst, are indexed as they come, for the aliens ticked after them.
+void Engine::_TickAll(size_t N) {
+   Profiled(ObjTickPR); Traced(ObjTickPR);
+   _IndexThreats(N);
+   for (size_t n = 0, Indexed = N; n < N; n++) {
+      _Store.Obj[n]->Tick();
+      if (_HasThreats) for (; Indexed < _Store.Size(); Indexed++) _IndexThreat(Indexed);
+   }
+}
+
+// Lances among the first N objects that are still in flight after the collisions may knock out debris and sparks.
+void Engine::_Strike(size_t N) {
+   Profiled(StrikePR); Traced(StrikePR);
+   for (size_t n = 0; n < N; n++)
+      if (_Store.Type[n] == LanceOT && !_Store.Dead[n] && _Sparks.Hit(ObjPos(_Store.X[n], _Store.Y[n]), _Store.Radius[n]))
+         _Store.Obj[n]->SetDead();
+}
+
+// Add new rocks and aliens to the game, by chance.
+void Engine::_Spawn() {
+   Profiled(SpawnPR); Traced(SpawnPR);
 // Add a rock to the game, with probability Prob.
    double Prob = 2.0*_Level*RockMakeProb*(1.0 - 1.0/(1.0 + (double)_Ticks/HalfMaxTicks));
-   if (Thing::RandB(Prob)) AddKuypier(BoulderOT, _Ticks);
+   if (_Rand.RandB(Prob)) AddKuypier(BoulderOT, _Ticks);
 // Add an alien to the game, with conditional probability Prob.
 // (Only one alien at a time may be present.)
    Prob = AlienProb*(1.0 - 1.0/(1.0 + (double)_Ticks/HalfMaxTicks));
-   if (Thing::RandB(Prob) && _Types(AlienOT) == 0) AddKuypier(AlienOT, 0);
-// Wrap the game space: update the size, as it may have changed.
-   N = _Objects.size();
-// Check for strays outside the game space.
-   for (size_t n = 0; n < N; n++) {
-   // The Kuypier extra space (rocks and aliens may roam well off the screen).
-      int X = _Xs/KuyperSize, Y = _Ys/KuyperSize;
-   // Players are stuck on the screen.
-      if (!_Objects[n]->Kuypier()) X = 0, Y = 0;
-   // Reset the new position on the other side of the play area.
-      ObjPos Pos(_Objects[n]->_Pos);
-      if (Pos.real() < -X) Pos = ObjPos(_Xs + X, Pos.imag());
-      if (Pos.imag() < -Y) Pos = ObjPos(Pos.real(), _Ys + Y);
-      if (Pos.real() > _Xs + X) Pos = ObjPos(-X, Pos.imag());
-      if (Pos.imag() > _Ys + Y) Pos = ObjPos(Pos.real(), -Y);
-      _Objects[n]->_Pos = Pos;
-   }
+   if (_Rand.RandB(Prob) && _Census[AlienOT] == 0) AddKuypier(AlienOT, 0);
 }
 
-// The number of type T objects.
-int Engine::_Types(TypeT T) const {
-   int Ts = 0;
-   size_t N = _Objects.size();
-   for (size_t n = 0; n < N; n++) if (_Objects[n]->Type() == T) Ts++;
-   return Ts;
-}
-
-// A pointer to the ship.
-Ship *Engine::_GetShip() const {
-// We hold the index of the ship for fast lookup as we expect our routines to access the ship object many times.
-// We check that our saved indexed indeed holds the ship index, and if not, we search for it.
-   size_t N = _Objects.size();
-   if (_ShipIx >= 0 && static_cast<size_t>(_ShipIx) < N && _Objects[_ShipIx]->Type() == ShipOT)
-   // Here we hold an index to it.
-      return static_cast<Ship *>(_Objects[_ShipIx]);
-   else for (size_t n = 0; n < N; n++) if (_Objects[n]->Type() == ShipOT) {
-   // Allow const method to set the property.
-   // This is for optimization only, and I don't regard it as modifying the state of the object (much).
-      *const_cast<int *>(&_ShipIx) = n;
-      return static_cast<Ship *>(_Objects[n]);
-   }
-   return nullptr;
+// Check for strays outside the game space, over the whole roster, as it may have grown.
+// The Kuypier extra space (rocks and aliens may roam well off the screen), while players are stuck on the screen:
+// reset each stray's position on the other side of the play area.
+void Engine::_WrapAll() {
+   Profiled(WrapPR); Traced(WrapPR);
+   Wrap(_Store.X.data(), _Store.Y.data(), _Store.Kuyp.data(), _Store.Size(), _Xs, _Ys, _Xs/KuyperSize, _Ys/KuyperSize);
 }
 
+// Move the objects, check for collisions, handle rebounds and set the appropriate flags, in that order.
+void Engine::_StateTick() {
+// Increment the counter.
+   if (++_Ticks >= 0x7fffffff) _Ticks = 1000;
+// Hold the count, because other objects will be added as parts of explosions.
+   size_t N = _Sweep();
+   _Move(N);
+   _TickAll(N);
+// Collisions: see who collided and sound out their explosions.
+// Note that the Tick() calls above may have added objects after the size N count, but this is OK.
+   _Collide(N);
+   _Strike(N);
+   _Spawn();
+   _WrapAll();
+}
+
+// A pointer to the ship, or nullptr if it is gone.
+// We hold the handle of the latest ship, as we expect our routines to access the ship object many times.
+Ship *Engine::_GetShip() const { return static_cast<Ship *>(Find(_ShipH)); }
+
 // class Engine: public methods
 // ────────────────────────────
 // Make a new Engine object.
-Engine::Engine() {
+Engine::Engine(): _Things(ThingSize), _Near(MaxObjs), _Threats(MaxObjs) {
+// Room for a busy game, so that the roster and collision lists seldom have to grow.
+   _Store.Reserve(MaxObjs), _Solid.reserve(MaxObjs), _Pairs.reserve(MaxObjs), _Handles.reserve(MaxObjs);
+   _FreeHandle = -1, _Gen = 0;
+   _HasThreats = false, _AlienCap = MaxAliens, _ResetCensus();
 // The default playing area.
 // See the playing area accessors for more information.
    _Xs = 535, _Ys = 400;
-   _ShipIx = -1, _Level = 0.5;
+   _Level = 0.5;
    _HiScore = 0, _Score = 0, _ExScore = 0, _Lives = 0;
-   _Active = false, _Ticks = 0, _NewLifeWait = 0;
+   _Active = false, _Ticks = 0, _NewLifeWait = 0, _EndDemoMark = 0, _EndGameMark = 0;
+   _Rec = nullptr, _Events = nullptr;
 }
 
 // Free an Engine object.
-Engine::~Engine() {
-   try {
-      size_t N = _Objects.size();
-      for (size_t n = 0; n < N; n++) delete _Objects[n];
-   } catch(...) { }
-}
+// The objects' storage is freed along with the pool; any recording of it is finished off.
+Engine::~Engine() { if (_Rec != nullptr) _Rec->Stop(); }
 
-// Add a type-T object.
-Thing *Engine::AddThing(TypeT T) {
+// Make a type-T object, in storage from the pool, with a row of its own at the end of the store; or nullptr, if T is not an object type.
+// The object is not yet issued a handle, nor is the row filled in beyond what its constructor gives it.
+Thing *Engine::_Make(TypeT T) {
    Thing *Obj = nullptr;
+   void *Slot = _Things.Get();
    switch (T) {
-      case BoulderOT: Obj = new Boulder(*this); break;
-      case StoneOT: Obj = new Stone(*this); break;
-      case PebbleOT: Obj = new Pebble(*this); break;
-      case ShipOT: Obj = new Ship(*this); break;
-      case AlienOT: Obj = new Alien(*this); break;
-      case LanceOT: Obj = new Lance(*this); break;
-      case DebrisOT: Obj = new Debris(*this); break;
-      case SparkOT: Obj = new Spark(*this); break;
-      case ThrustOT: Obj = new Thrust(*this); break;
-      case LabelOT: Obj = new Label(*this, DefLabelTime); break;
+      case BoulderOT: Obj = new (Slot) Boulder(*this); break;
+      case StoneOT: Obj = new (Slot) Stone(*this); break;
+      case PebbleOT: Obj = new (Slot) Pebble(*this); break;
+      case ShipOT: Obj = new (Slot) Ship(*this); break;
+      case AlienOT: Obj = new (Slot) Alien(*this); break;
+      case LanceOT: Obj = new (Slot) Lance(*this); break;
+      case LabelOT: Obj = new (Slot) Label(*this, DefLabelTime); break;
       default:
 #if 0
          assert(false); // Error.
 #endif
+         _Things.Put(Slot);
       break;
    }
-   if (Obj != nullptr) _Objects.push_back(Obj);
+   return Obj;
+}
+
+// Add a type-T object, in storage from the pool.
+Thing *Engine::AddThing(TypeT T) {
+   Thing *Obj = _Make(T);
+// The object has taken its row in the store; fill in the columns given by its type.
+   if (Obj != nullptr) {
+      size_t Row = Obj->_Row;
+      _Store.Type[Row] = T, _Store.Mass[Row] = Traits[T].Mass, _Store.Kuyp[Row] = Traits[T].Kuypier? 1.0: 0.0;
+      Handle H = _Issue(Obj); if (T == ShipOT) _ShipH = H;
+      if (++_Census[T] > _PeakCensus[T]) _PeakCensus[T] = _Census[T];
+   }
    return Obj;
 }
 
 // Add a type-T object at Pos, with orientation Dir.
 Thing *Engine::AddThing(TypeT T, const ObjPos &Pos, const ObjPos &Dir) {
-   Thing *Obj = AddThing(T); Obj->_Pos = Pos, Obj->_Dir = Dir;
+   Thing *Obj = AddThing(T); Obj->SetPos(Pos), Obj->SetDir(Dir);
    return Obj;
 }
 
+// Add a type-T particle (Particulate(T)) at Pos, moving by Dir.
+// Thrust is a short puff at angle Angle, lasting 2 ticks.
+// Debris and sparks take a random rumpled shape, angle and spin (of about 8 degrees per tick), and a random lifetime, drawn up front:
+// debris lasts 3 seconds, then has a 1 in 10 chance of going on each tick;
+// sparks have a 1 in 10 chance of going on each tick, for 2 seconds, and a 1 in 2 chance, after that.
+void Engine::AddParticle(TypeT T, const ObjPos &Pos, const ObjPos &Dir, double Angle/* = 0.0*/) {
+   if (T == ThrustOT) {
+      _Sparks.Add(T, ThrustSH, Pos, Dir, Angle, 0.0, _Ticks + 2);
+      if (_Sparks.Count(T) > _PeakCensus[T]) _PeakCensus[T] = _Sparks.Count(T);
+      return;
+   }
+// The variant, the angle, the spin direction and the lifetime.
+   double R[4]; _Rand.Fill(R, 4);
+   ShapeT Shape = (ShapeT)(DebrisSH + (int)(R[0]*DebrisVariants));
+   double Twist = TwoPi*8.0/360.0; if (R[2] < 0.5) Twist = -Twist;
+// The number of ticks to the first success, in a run of trials with probability P of success.
+   auto Trials = [](double U, double P) { return 1 + (int)(log(1.0 - U)/log(1.0 - P)); };
+   int Life;
+   if (T == DebrisOT) Life = 3*TickRate - 1 + Trials(R[3], 0.1);
+   else if ((Life = Trials(R[3], 0.1)) >= 2*TickRate) Life = 2*TickRate - 1 + Trials(_Rand.RandR(), 0.5);
+   _Sparks.Add(T, Shape, Pos, Dir, TwoPi*R[1], Twist, _Ticks + Life);
+   if (_Sparks.Count(T) > _PeakCensus[T]) _PeakCensus[T] = _Sparks.Count(T);
+}
+
+// Tell the event stream, if there is one, of the event Ev, which befell a type-T object at Pos, with the count N, at this tick.
+void Engine::Emit(EventT Ev, TypeT T, const ObjPos &Pos, int N/* = 0*/) {
+   if (_Events == nullptr) return;
+   EventRecT E = { Ev, T, Pos, N, _Ticks };
+   _Events->Push(E);
+}
+
 // Add a randomly-located object into the Kuypier region.
 // The velocity may increase statistically according to the difficulty level and value of Tick as the game goes on.
 Thing *Engine::AddKuypier(TypeT T, int Tick) {
    Thing *Obj = AddThing(T);
+// Draw all the random values at once: two for the orientation, then three for the position.
+   double R[5]; _Rand.Fill(R, 5);
 // The orientation.
    double Speed = RockSpeedMult*(0.5 + MaxShipSpeed*_Level*(1.0 - 1.0/(1.0 + (double)Tick/HalfMaxTicks)));
-   Obj->_Dir = ObjPos(Speed*(-1.0 + 2.0*Thing::RandR()), Speed*(-1.0 + 2.0*Thing::RandR()));
+   Obj->SetDir(ObjPos(Speed*(-1.0 + 2.0*R[0]), Speed*(-1.0 + 2.0*R[1])));
 // The position.
-   Obj->_Pos = Thing::RandB()?
+   Obj->SetPos(R[2] < 0.5?
    // Place it either left or right.
-      ObjPos(Thing::RandB()? -_Xs/KuyperSize/2: _Xs + _Xs/KuyperSize/2, Thing::RandR()*(_Ys + 2*_Ys/KuyperSize) - _Ys/KuyperSize):
+      ObjPos(R[3] < 0.5? -_Xs/KuyperSize/2: _Xs + _Xs/KuyperSize/2, R[4]*(_Ys + 2*_Ys/KuyperSize) - _Ys/KuyperSize):
    // Place it either top or bottom.
-      ObjPos(Thing::RandR()*(_Xs + 2*_Xs/KuyperSize) - _Xs/KuyperSize, Thing::RandB()? -_Ys/KuyperSize/2: _Ys + _Ys/KuyperSize/2);
+      ObjPos(R[3]*(_Xs + 2*_Xs/KuyperSize) - _Xs/KuyperSize, R[4] < 0.5? -_Ys/KuyperSize/2: _Ys + _Ys/KuyperSize/2)
+   );
    return Obj;
 }
 
+// The engine's random number generator; set its seed to replay a game exactly.
+Random &Engine::GetRandom() { return _Rand; }
+void Engine::SetSeed(uint64_t Seed) {
+   if (_Rec != nullptr) _Rec->NoteSeed(Seed);
+   _Rand.Seed(Seed);
+}
+
+// The number of storage blocks the engine has taken from the heap for its objects, over its lifetime.
+// This stops growing once the pool has reached the peak number of objects in play.
+long Engine::GetAllocs() const { return _Things.GetAllocs(); }
+
+// Get/set the replay recorder (nullptr for none); this is meant to be done by the recorder itself, in Recorder::Start() and Recorder::Stop().
+Recorder *Engine::GetRecorder() const { return _Rec; }
+void Engine::SetRecorder(Recorder *Rec) { _Rec = Rec; }
+
+// Get/set the event stream, or nullptr, for none.
+// The events are outputs only, and take no part in the engine's state, its snapshots or its replays.
+Events *Engine::GetEvents() const { return _Events; }
+void Engine::SetEvents(Events *Evs) { _Events = Evs; }
+
+// A checksum (64-bit FNV-1a) of the engine's state: the random number generator, the game clock, score and lives, the play area,
+// and the type, dead flag, position and velocity of each object, bit for bit, in roster order, and the number of particles.
+// The objects' cold state is left out, since any difference in it soon shows up in the objects' motion.
+// Two engines that were fed the same inputs from the same start have the same checksum, tick by tick, so replays check theirs against it.
+uint64_t Engine::Checksum() const {
+   uint64_t Sum = 0xcbf29ce484222325;
+   auto Mix = [&Sum](uint64_t N) {
+      for (int n = 0; n < 8; n++, N >>= 8) Sum = (Sum ^ (N&0xff))*0x100000001b3;
+   };
+   auto MixD = [&Mix](double X) { uint64_t N; memcpy(&N, &X, sizeof N); Mix(N); };
+   uint64_t Rand[4]; _Rand.GetState(Rand);
+   for (int n = 0; n < 4; n++) Mix(Rand[n]);
+// The clock, score and lives are left as they were when the engine is stopped, so they only count while it is active.
+   Mix(_Active);
+   if (_Active) Mix((uint64_t)_Ticks), Mix((uint64_t)_Score), Mix((uint64_t)_Lives);
+   Mix((uint64_t)_Xs), Mix((uint64_t)_Ys);
+   size_t N = _Store.Size(); Mix(N);
+   for (size_t n = 0; n < N; n++)
+      Mix(_Store.Type[n]), Mix(_Store.Dead[n]), MixD(_Store.X[n]), MixD(_Store.Y[n]), MixD(_Store.DX[n]), MixD(_Store.DY[n]);
+   Mix(_Sparks.Size());
+   return Sum;
+}
+
+// The size of a snapshot of the engine, as it is now.
+size_t Engine::SaveSize() const { return SnapLayout(_Store.Size(), _Handles.size(), _Sparks._Used).Bytes; }
+
+// Save a snapshot of the whole engine state into the Size bytes at Buf, which must be 8-byte aligned,
+// and return its size, or 0 if it does not fit (see SaveSize()).
+// The columns of the store and the particle ring are copied out whole; only the objects' cold state is gathered object by object.
+// The padding is zeroed, so that the same state always gives the same bytes.
+size_t Engine::Save(void *Buf, size_t Size) const {
+   size_t N = _Store.Size(), Hs = _Handles.size(), Ps = _Sparks._Used;
+   SnapLayout L(N, Hs, Ps);
+   if (Buf == nullptr || ((uintptr_t)Buf&7) != 0 || Size < L.Bytes) return 0;
+   char *B = static_cast<char *>(Buf); memset(B, 0, L.Bytes);
+   SnapHeadT &H = *reinterpret_cast<SnapHeadT *>(B);
+   H.Magic = SnapMagic, H.Version = SnapVersion, H.Order = SnapOrder, H.Bytes = L.Bytes;
+   H.HeadBytes = sizeof(SnapHeadT), H.ThingBytes = sizeof(SnapThingT), H.HandleBytes = sizeof(SnapHandleT), H.TypeCount = TypeN;
+   H.Objs = N, H.Handles = Hs, H.Sparks = Ps, H.SparkHead = _Sparks._Head;
+   _Rand.GetState(H.Rand), H.Level = _Level;
+   H.Ticks = _Ticks, H.Lives = _Lives, H.InitRocks = _InitRocks, H.Score = _Score, H.ExScore = _ExScore, H.HiScore = _HiScore, H.Xs = _Xs, H.Ys = _Ys;
+   H.NewLifeWait = _NewLifeWait, H.EndDemoMark = _EndDemoMark, H.EndGameMark = _EndGameMark, H.AlienCap = _AlienCap;
+   H.FreeHandle = _FreeHandle, H.ShipIx = _ShipH.Ix, H.Gen = _Gen, H.ShipGen = _ShipH.Gen;
+   for (int T = 0; T < TypeN; T++) H.Census[T] = _Census[T], H.PeakCensus[T] = _PeakCensus[T], H.SparkCount[T] = _Sparks._Count[T];
+   H.SparkNow = _Sparks._Now, H.SparkLive = _Sparks._Live;
+   H.Active = _Active;
+// The roster.
+   auto Out = [B](size_t At, const void *From, size_t Bytes) { if (Bytes > 0) memcpy(B + At, From, Bytes); };
+   Out(L.X, _Store.X.data(), N*sizeof(double)), Out(L.Y, _Store.Y.data(), N*sizeof(double));
+   Out(L.DX, _Store.DX.data(), N*sizeof(double)), Out(L.DY, _Store.DY.data(), N*sizeof(double));
+   Out(L.Radius, _Store.Radius.data(), N*sizeof(double)), Out(L.Mass, _Store.Mass.data(), N*sizeof(double)), Out(L.Kuyp, _Store.Kuyp.data(), N*sizeof(double));
+   Out(L.Type, _Store.Type.data(), N), Out(L.Dead, _Store.Dead.data(), N);
+   SnapThingT *Things = reinterpret_cast<SnapThingT *>(B + L.Things);
+   for (size_t n = 0; n < N; n++) {
+      const Thing *Obj = _Store.Obj[n]; SnapThingT &R = Things[n];
+      R.Ix = Obj->_Id.Ix, R.Gen = Obj->_Id.Gen;
+      R.Twist = Obj->_Twist, R.Angle = Obj->_Angle, R.TurnAngle = Obj->_TurnAngle, R.TurnX = Obj->_Turn.real(), R.TurnY = Obj->_Turn.imag();
+      R.Shape = Obj->_Shape, R.Ticks = Obj->_Ticks, R.Now = Obj->_Now, R.Pts = Obj->_Pts;
+      strncpy(R.Caption, Obj->_Caption, MaxCaption); // Zero-filled past the end of the caption.
+      if (_Store.Type[n] == ShipOT) {
+         const Ship *Sh = static_cast<const Ship *>(Obj);
+         R.Orient = Sh->_Orient, R.Spin = Sh->_Spin, R.FireCharge = Sh->_FireCharge;
+         R.Pushing = Sh->_Pushing, R.Firing = Sh->_Firing, R.FireLock = Sh->_FireLock, R.JustFired = Sh->_JustFired;
+      } else if (_Store.Type[n] == LabelOT) R.Life = static_cast<const Label *>(Obj)->GetLife();
+   }
+   SnapHandleT *Handles = reinterpret_cast<SnapHandleT *>(B + L.Handles);
+   for (size_t h = 0; h < Hs; h++) {
+      const HandleT &E = _Handles[h];
+      Handles[h].Row = E.Obj != nullptr? (int32_t)E.Obj->_Row: -1, Handles[h].Next = E.Next, Handles[h].Gen = E.Gen;
+   }
+// The particle ring.
+   const Particles &S = _Sparks;
+   Out(L.SparkX, S._X.data(), Ps*sizeof(double)), Out(L.SparkY, S._Y.data(), Ps*sizeof(double));
+   Out(L.SparkDX, S._DX.data(), Ps*sizeof(double)), Out(L.SparkDY, S._DY.data(), Ps*sizeof(double));
+   Out(L.SparkAngle, S._Angle.data(), Ps*sizeof(double)), Out(L.SparkTwist, S._Twist.data(), Ps*sizeof(double));
+   Out(L.SparkRadius, S._Radius.data(), Ps*sizeof(double)), Out(L.SparkExpire, S._Expire.data(), Ps*sizeof(int32_t));
+   Out(L.SparkType, S._Type.data(), Ps), Out(L.SparkShape, S._Shape.data(), Ps);
+   return L.Bytes;
+}
+
+// Restore the engine to the snapshot in the Size bytes at Buf (8-byte aligned), and tell whether it was a good one.
+// A snapshot is validated by its header (SnapHead()); beyond that, the types, shapes and handle table, by which the restore and the engine index,
+// are checked, before anything is changed, so that a bad snapshot leaves the engine as it was:
+// each object and its handle table entry must point to each other, under the same generation, so that no two objects share an entry;
+// the free list must run through free entries only, and end; and the ship's handle, if it is live, must be to a ship.
+// The fields used as indices, or as the bounds of a loop, must be in range: the ship's orientation and spin, and each object's font;
+// the positions, velocities and radii, of the objects and the particles, must be finite, since they are cast to grid cells;
+// and the random number generator's state must not be all zeros.
+// The census is counted afresh from the roster, rather than taken on trust.
+// The objects are made afresh, in storage from the pool, their cold state filled in, and the store's columns and the particle ring copied in whole.
+// A recording in progress is finished off, since a replay cannot follow the engine through the jump.
+bool Engine::Restore(const void *Buf, size_t Size) {
+   const SnapHeadT *HP = SnapHead(Buf, Size); if (HP == nullptr) return false;
+   const SnapHeadT &H = *HP;
+   const char *B = static_cast<const char *>(Buf);
+   size_t N = H.Objs, Hs = H.Handles, Ps = H.Sparks;
+   SnapLayout L(N, Hs, Ps);
+   const unsigned char *Type = reinterpret_cast<const unsigned char *>(B + L.Type);
+   const SnapThingT *Things = reinterpret_cast<const SnapThingT *>(B + L.Things);
+   const SnapHandleT *Handles = reinterpret_cast<const SnapHandleT *>(B + L.Handles);
+   for (size_t n = 0; n < N; n++)
+      if (Type[n] == NoOT || Type[n] >= TypeN || Particulate((TypeT)Type[n])) return false;
+      else if (Things[n].Shape < 0 || Things[n].Shape >= ShapeN || Things[n].Ix < 0 || Things[n].Ix >= (int32_t)Hs) return false;
+      else if (Things[n].Pts < 0 || Things[n].Pts >= FontN) return false;
+      else if (Type[n] == ShipOT && (Things[n].Orient < 0 || Things[n].Orient >= ShipTurns || Things[n].Spin < -1 || Things[n].Spin > 1)) return false;
+   auto Finite = [B](size_t At, size_t Count) {
+      const double *X = reinterpret_cast<const double *>(B + At);
+      for (size_t n = 0; n < Count; n++) if (!isfinite(X[n])) return false;
+      return true;
+   };
+   if (!Finite(L.X, N) || !Finite(L.Y, N) || !Finite(L.DX, N) || !Finite(L.DY, N) || !Finite(L.Radius, N)) return false;
+   if (!Finite(L.SparkX, Ps) || !Finite(L.SparkY, Ps) || !Finite(L.SparkDX, Ps) || !Finite(L.SparkDY, Ps) || !Finite(L.SparkRadius, Ps)) return false;
+   if ((H.Rand[0] | H.Rand[1] | H.Rand[2] | H.Rand[3]) == 0) return false;
+   for (size_t h = 0; h < Hs; h++)
+      if (Handles[h].Row < -1 || Handles[h].Row >= (int32_t)N || Handles[h].Next < -1 || Handles[h].Next >= (int32_t)Hs) return false;
+      else if (Handles[h].Row >= 0 && Things[Handles[h].Row].Ix != (int32_t)h) return false;
+   for (size_t n = 0; n < N; n++)
+      if (Handles[Things[n].Ix].Row != (int32_t)n || Handles[Things[n].Ix].Gen != Things[n].Gen) return false;
+   if (H.FreeHandle < -1 || H.FreeHandle >= (int32_t)Hs) return false;
+   size_t Frees = 0;
+   for (int32_t h = H.FreeHandle; h >= 0; h = Handles[h].Next)
+      if (Handles[h].Row != -1 || ++Frees > Hs) return false;
+   if (H.ShipIx < -1 || H.ShipIx >= (int32_t)Hs) return false;
+   else if (H.ShipIx >= 0 && Handles[H.ShipIx].Row >= 0 && Handles[H.ShipIx].Gen == H.ShipGen && Type[Handles[H.ShipIx].Row] != ShipOT) return false;
+   const unsigned char *SparkType = reinterpret_cast<const unsigned char *>(B + L.SparkType), *SparkShape = reinterpret_cast<const unsigned char *>(B + L.SparkShape);
+   for (size_t p = 0; p < Ps; p++)
+      if (SparkType[p] >= TypeN || !Particulate((TypeT)SparkType[p]) || SparkShape[p] >= ShapeN) return false;
+   if (_Rec != nullptr) _Rec->Stop();
+// The roster: the objects' constructors give them their rows, in order, and then the columns are copied in over what they set.
+   _Store.Clear(), _Things.Reset(), _Handles.clear();
+   for (size_t n = 0; n < N; n++) {
+      Thing *Obj = _Make((TypeT)Type[n]); const SnapThingT &R = Things[n];
+      Obj->_Id = Handle(R.Ix, R.Gen);
+      Obj->_Twist = R.Twist, Obj->_Angle = R.Angle, Obj->_TurnAngle = R.TurnAngle, Obj->_Turn = ObjPos(R.TurnX, R.TurnY);
+      Obj->_Shape = (ShapeT)R.Shape, Obj->_Ticks = R.Ticks, Obj->_Now = R.Now, Obj->_Pts = (FontT)R.Pts;
+      memcpy(Obj->_Caption, R.Caption, MaxCaption), Obj->_Caption[MaxCaption - 1] = '\0';
+      if (Type[n] == ShipOT) {
+         Ship *Sh = static_cast<Ship *>(Obj);
+         Sh->_Orient = R.Orient, Sh->_Spin = R.Spin, Sh->_FireCharge = R.FireCharge;
+         Sh->_Pushing = R.Pushing, Sh->_Firing = R.Firing, Sh->_FireLock = R.FireLock, Sh->_JustFired = R.JustFired;
+      } else if (Type[n] == LabelOT) static_cast<Label *>(Obj)->SetLife(R.Life);
+   }
+   auto In = [B](void *To, size_t At, size_t Bytes) { if (Bytes > 0) memcpy(To, B + At, Bytes); };
+   In(_Store.X.data(), L.X, N*sizeof(double)), In(_Store.Y.data(), L.Y, N*sizeof(double));
+   In(_Store.DX.data(), L.DX, N*sizeof(double)), In(_Store.DY.data(), L.DY, N*sizeof(double));
+   In(_Store.Radius.data(), L.Radius, N*sizeof(double)), In(_Store.Mass.data(), L.Mass, N*sizeof(double)), In(_Store.Kuyp.data(), L.Kuyp, N*sizeof(double));
+   In(_Store.Type.data(), L.Type, N), In(_Store.Dead.data(), L.Dead, N);
+   _Handles.resize(Hs);
+   for (size_t h = 0; h < Hs; h++) {
+      HandleT &E = _Handles[h];
+      E.Obj = Handles[h].Row >= 0? _Store.Obj[Handles[h].Row]: nullptr, E.Gen = Handles[h].Gen, E.Next = Handles[h].Next;
+   }
+// The particle ring.
+   Particles &S = _Sparks;
+   In(S._X.data(), L.SparkX, Ps*sizeof(double)), In(S._Y.data(), L.SparkY, Ps*sizeof(double));
+   In(S._DX.data(), L.SparkDX, Ps*sizeof(double)), In(S._DY.data(), L.SparkDY, Ps*sizeof(double));
+   In(S._Angle.data(), L.SparkAngle, Ps*sizeof(double)), In(S._Twist.data(), L.SparkTwist, Ps*sizeof(double));
+   In(S._Radius.data(), L.SparkRadius, Ps*sizeof(double)), In(S._Expire.data(), L.SparkExpire, Ps*sizeof(int32_t));
+   In(S._Type.data(), L.SparkType, Ps), In(S._Shape.data(), L.SparkShape, Ps);
+   S._Used = Ps, S._Head = H.SparkHead, S._Live = H.SparkLive, S._Now = H.SparkNow;
+// The scalars, last of all, since making the rocks afresh draws on the random number generator.
+   for (int T = 0; T < TypeN; T++) _Census[T] = 0;
+   for (size_t n = 0; n < N; n++) _Census[Type[n]]++;
+   for (int T = 0; T < TypeN; T++) _PeakCensus[T] = H.PeakCensus[T] > _Census[T]? H.PeakCensus[T]: _Census[T], S._Count[T] = H.SparkCount[T];
+   _Rand.SetState(H.Rand), _Level = H.Level;
+   _Ticks = H.Ticks, _Lives = H.Lives, _InitRocks = H.InitRocks, _Score = H.Score, _ExScore = H.ExScore, _HiScore = H.HiScore, _Xs = H.Xs, _Ys = H.Ys;
+   _NewLifeWait = H.NewLifeWait, _EndDemoMark = H.EndDemoMark, _EndGameMark = H.EndGameMark, _AlienCap = H.AlienCap;
+   _FreeHandle = H.FreeHandle, _Gen = H.Gen, _ShipH = Handle(H.ShipIx, H.ShipGen);
+   _Active = H.Active != 0;
+   _HasThreats = false;
+   return true;
+}
+
 // The object count.
-size_t Engine::ObjN() const { return _Objects.size(); }
+size_t Engine::ObjN() const { return _Store.Size(); }
 
 // The object at index N.
-Thing *Engine::ObjAtN(size_t N) const { return _Objects[N]; }
+Thing *Engine::ObjAtN(size_t N) const { return _Store.Obj[N]; }
+
+// The nearest threat to an alien at Pos, among the objects in play at the start of this tick and those added since, or nullptr if there are none.
+// This is only for the aliens' use, in their Tick().
+Thing *Engine::NearestThreat(const ObjPos &Pos) const {
+   if (!_HasThreats) return nullptr;
+   const Store &S = _Store;
+   int n = _Threats.Nearest(Pos, [&S, &Pos](int n) { return abs(Pos - ObjPos(S.X[n], S.Y[n])); });
+   return n < 0? nullptr: S.Obj[n];
+}
+
+// The census: the number of type-T objects (or particles) in play, and the most there have been at once, this game.
+// Objects are counted from when they are added until they are swept from the roster, on the tick after they die;
+// particles are counted while they are in flight.
+int Engine::Census(TypeT T) const { return Particulate(T)? _Sparks.Count(T): _Census[T]; }
+int Engine::PeakCensus(TypeT T) const { return _PeakCensus[T]; }
+
+// The particles, for drawing, and the number in flight.
+const Particles &Engine::GetParticles() const { return _Sparks; }
+size_t Engine::ParticleN() const { return _Sparks.Size(); }
+
+// The object with handle H, or nullptr if it is gone.
+Thing *Engine::Find(Handle H) const {
+   return H.Ix >= 0 && static_cast<size_t>(H.Ix) < _Handles.size() && _Handles[H.Ix].Gen == H.Gen? _Handles[H.Ix].Obj: nullptr;
+}
 
 // The game mode: active versus demo.
 bool Engine::GetActive() const { return _Active; }
@@ -263,50 +644,62 @@ bool Engine::InDemo() const { return _Active && _EndDemoMark > 0; }
 bool Engine::InGame() const { return _Active && _EndDemoMark <= 0; }
 
 // Test for ‟GAME OVER” after a short pause of its being set, to allow time for the label to be seen.
-bool Engine::EndGame() const { return !_Active || (_EndGameMark > 0 && time(0) > _EndGameMark); }
+bool Engine::EndGame() const { return !_Active || (_EndGameMark > 0 && _Ticks > _EndGameMark); }
 
 // Start a new game.
 void Engine::BegGame(int Rocks/* = 10*/) {
+   if (_Rec != nullptr) _Rec->Note(BegGameIN, Rocks);
    _Empty(true);
    _Ticks = 0, _Score = 0, _EndGameMark = 0, _Active = true, _EndDemoMark = 0, _InitRocks = Rocks, _Lives = 3;
 // Add the start-up label.
    Thing *Lab = AddThing(LabelOT, ObjPos(_Xs/2, _Ys/2)); Lab->SetPts(MediumLF), Lab->SetCaption("NEW GAME");
 // Setting this to non-zero will create new rocks and a ship after a short interval.
-   _NewLifeWait = time(0) + RevivePause;
+   _NewLifeWait = _Ticks + RevivePause*TickRate;
 }
 
-// Start a demo game for T seconds.
+// Start a demo game for T seconds of the engine clock.
 // An earlier version had an ‟Aliens” flag, to permit a demo with only flocking aliens.
-void Engine::BegDemo(time_t T/* = 20*/, int Rocks/* = 10*/) {
+void Engine::BegDemo(int T/* = 20*/, int Rocks/* = 10*/) {
+   if (_Rec != nullptr) _Rec->Note(BegDemoIN, T, Rocks);
    _Empty(true);
-   _Ticks = 0, _Score = 0, _EndGameMark = 0, _Active = true, _EndDemoMark = time(0) + T, _InitRocks = Rocks, _Lives = 1;
+   _Ticks = 0, _Score = 0, _EndGameMark = 0, _Active = true, _EndDemoMark = T*TickRate, _InitRocks = Rocks, _Lives = 1;
 // Add the start-up label.
    Thing *Lab = AddThing(LabelOT, ObjPos(_Xs/2, _Ys/2)); Lab->SetPts(MediumLF), Lab->SetCaption("DEMO");
 // Setting this to non-zero will create new rocks and a ship after a short interval.
-   _NewLifeWait = time(0) + RevivePause;
+   _NewLifeWait = _Ticks + RevivePause*TickRate;
 }
 
 // Clear: stop the game.
-void Engine::Stop() { _Active = false, _Lives = 0, _Empty(true); }
+void Engine::Stop() {
+   if (_Rec != nullptr) _Rec->Note(StopIN);
+   _Active = false, _Lives = 0, _Empty(true);
+}
 
 // The Game State Machine, itself.
-// This is meant to be called on the clock, so as to advance the game in 1/10 second increments.
+// This is meant to be called on the clock, so as to advance the game in 1/TickRate second increments.
+// Each call is one tick of the engine clock, from which all the game's timings are taken,
+// so the game may be run faster or slower than real time without changing its course.
 // Graphics should be rendered between calls to Tick().
 void Engine::Tick() {
+// The recorder counts every tick, idle or not, so that the inputs made in between land on the right ones.
+   if (_Rec != nullptr) _Rec->Tick();
    if (!_Active) return;
+   Profiled(TickPR); Traced(TickPR);
    if (InDemo()) {
    // Demo Mode: control the ship randomly.
       Ship *Sh = _GetShip();
       if (Sh != nullptr) {
       // Reset the fire lock.
          Sh->ReLoad(true);
+      // Draw the autopilot's random values at once.
+         double R[3]; _Rand.Fill(R, 3);
       // One in 3 chance of firing.
-         if (Thing::RandB(0.3)) Sh->Fire();
+         if (R[0] < 0.3) Sh->Fire();
       // One in 10 chance of changing what ship was doing on last tick.
-         if (Thing::RandB(0.1)) {
+         if (R[1] < 0.1) {
             Sh->SetSpin(0), Sh->SetPushing(false);
          // New random action: 1/5 thrust, 3/10 rotate left, 3/10 rotate right, 1/5 do nothing.
-            double Act = Thing::RandR();
+            double Act = R[2];
             if (Act < 0.2) Sh->SetPushing(true);
             else if (Act < 0.5) Sh->SetSpin(-1);
             else if (Act < 0.8) Sh->SetSpin(+1);
@@ -315,6 +708,7 @@ void Engine::Tick() {
    }
 // Update the game objects.
    _StateTick();
+   TraceCount("objects", _Store.Size()), TraceCount("particles", _Sparks.Size());
 // Deal with high-score and restart events.
    if (!InDemo()) {
    // Update the score records.
@@ -323,7 +717,7 @@ void Engine::Tick() {
 // Implement the game start/end events.
    bool Ended = false;
 // Do we need a new ship or to create initial rocks, etc.
-   if (_NewLifeWait > 0 && time(0) > _NewLifeWait) {
+   if (_NewLifeWait > 0 && _Ticks > _NewLifeWait) {
    // Avoid repetitions.
       _NewLifeWait = 0;
    // Add a new ship and re-create the initial rocks or end the game if there are no lives left.
@@ -335,14 +729,17 @@ void Engine::Tick() {
       }
    }
 // Demo timeout.
-   Ended |= InDemo() && time(0) > _EndDemoMark;
+   Ended |= InDemo() && _Ticks > _EndDemoMark;
    if (Ended && _EndGameMark == 0) {
    // Add the End-Of-Game label.
-      _EndGameMark = time(0) + EndGamePause;
+      _EndGameMark = _Ticks + EndGamePause*TickRate;
       Thing *Lab = AddThing(LabelOT, ObjPos(_Xs/2, _Ys/2)); Lab->SetPts(LargeLF), Lab->SetCaption("GAME OVER");
    }
 }
 
+// The engine clock: the number of ticks since the start of the game or demo.
+int Engine::GetTicks() const { return _Ticks; }
+
 // Get the number of lives.
 int Engine::GetLives() const { return _Lives; }
 
@@ -360,32 +757,45 @@ void Engine::SetHiScore(int Score) { _HiScore = Score; }
 // Get/set the game level; higher = more difficult games.
 double Engine::GetLevel() const { return _Level; }
 void Engine::SetLevel(const double &Level) {
+   if (_Rec != nullptr) _Rec->NoteLevel(Level);
    if (Level > 0.0 && Level <= 1.0) _Level = Level;
 }
 
 // Cheat: add an alien to the game.
 void Engine::AddAlienCheat() {
-   if (_Active && _Types(AlienOT) < 15) AddKuypier(AlienOT, 0);
+   if (_Rec != nullptr) _Rec->Note(AlienIN);
+   if (_Active && _Census[AlienOT] < _AlienCap) AddKuypier(AlienOT, 0);
+}
+
+// Get/set the cap on the number of aliens that AddAlienCheat() may bring in; it may be raised for stress testing.
+int Engine::GetAlienCap() const { return _AlienCap; }
+void Engine::SetAlienCap(int Cap) {
+   if (_Rec != nullptr) _Rec->Note(AlienCapIN, Cap);
+   _AlienCap = Cap;
 }
 
 // Rotate the ship (Spin == -1: left, Spin == 0: stop, Spin == +1: right).
 void Engine::SetSpin(int Spin) {
+   if (_Rec != nullptr) _Rec->Note(SpinIN, Spin);
    Ship *Sh = _GetShip();
    if (Sh != nullptr && !InDemo()) Sh->SetSpin(Spin);
 }
 
 // Thrust-switcher.
 void Engine::SetPushing(bool Pushing) {
+   if (_Rec != nullptr) _Rec->Note(PushIN, Pushing);
    Ship *Sh = _GetShip();
    if (Sh != nullptr && !InDemo()) Sh->SetPushing(Pushing);
 }
 
 // Fire, release fire and ship fire charge.
 void Engine::Fire() {
+   if (_Rec != nullptr) _Rec->Note(FireIN);
    Ship *Sh = _GetShip();
    if (Sh != nullptr && !InDemo()) Sh->Fire();
 }
 void Engine::ReLoad() {
+   if (_Rec != nullptr) _Rec->Note(ReLoadIN);
    Ship *Sh = _GetShip();
    if (Sh != nullptr && !InDemo()) Sh->ReLoad(false);
 }
@@ -394,18 +804,11 @@ int Engine::Charge() const {
    return Sh != nullptr? Sh->FireCharge(): 0;
 }
 
-// Get the latest rock explosion (NoOT = silent), lance, thrust, alien and death sounds.
-TypeT Engine::GetBoomSnd() const { return _BoomSnd; }
-bool Engine::GetLanceSnd() const {
-   Ship *Sh = _GetShip();
-   return Sh != nullptr && Sh->JustFired();
-}
+// Get the thrust sound: whether the ship is pushing.
 bool Engine::GetThrustSnd() const {
    Ship *Sh = _GetShip();
    return Sh != nullptr && Sh->GetPushing();
 }
-bool Engine::GetAlienSnd() const { return _AlienSnd; }
-bool Engine::GetDiedSnd() const { return _DiedSnd; }
 
 // Get/set the playing width and height.
 // Notes:
@@ -418,7 +821,10 @@ void Engine::GetPlayDims(int *XsP, int *YsP) const {
    if (YsP != nullptr) *YsP = _Ys;
 }
 
-void Engine::SetPlayDims(int Xs, int Ys) { _Xs = Xs, _Ys = Ys; }
+void Engine::SetPlayDims(int Xs, int Ys) {
+   if (_Rec != nullptr) _Rec->Note(DimsIN, Xs, Ys);
+   _Xs = Xs, _Ys = Ys;
+}
 
 // The minimum dimension.
 int Engine::MinDim() const { return _Ys < _Xs? _Ys: _Xs; }
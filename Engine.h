@@ -3,22 +3,35 @@
 
 // Asteroid Style Game: The engine for holding and updating the game artifacts.
 // Copyright (c) 2009 Big Angry Dog, (c) 2016-2018 Darth Ninja, (c) 2021 Darth Spectra
-#include <time.h>
 #include <vector>
+#include "Events.h"
 #include "Objects.h"
+#include "Grid.h"
+#include "Particles.h"
+#include "Pool.h"
+#include "Random.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include "Store.h"
 
 namespace Asteroid {
 // Game Presets
+// The number of objects that the engine sets aside room for; it may hold more, at the cost of growing its lists.
+const int MaxObjs = 1024;
 // Used to calculate size of Kuypier region.
 const int KuyperSize = 6;
+// The engine clock rate, in ticks per second, used to convert the timings in seconds;
+// this matches the default 45 millisecond poll rate of the game.
+const int TickRate = 22;
 // Timings in seconds: pause before new life, default text label life, pause before EndGame().
 const int RevivePause = 2, DefLabelTime = 2, EndGamePause = 3;
-// Maxima: FireCharge(), object speed (controls the game speed), alien speed.
-const int MaxCharge = 6, MaxShipSpeed = 14, MaxAlienSpeed = 8;
+// Maxima: FireCharge(), object speed (controls the game speed), alien speed, the default cap on cheat-added aliens.
+const int MaxCharge = 6, MaxShipSpeed = 14, MaxAlienSpeed = 8, MaxAliens = 15;
 // Timings in ticks: to half max rock speed, before rocks can blow up, before fire charge increases.
 const int HalfMaxTicks = 1500, RockLifeTicks = 25, ReChargeTicks = 12;
-// Ship rotate delta per tick.
-const double ShipRotateRate = 9.0;
+// Ship rotate delta per tick (in degrees), and the number of orientations that this leaves the ship in a full turn.
+constexpr double ShipRotateRate = 9.0;
+constexpr int ShipTurns = (int)(360.0/ShipRotateRate);
 // Probabilities: rock and alien creation at 0.5 HalfMaxTicks; spontaneous rock explosion.
 const double RockMakeProb = 0.02, AlienProb = 0.005, RockBreakProb = 0.001;
 // Game speed controls: ship thrust factor, ship fire recoil, alien thrust factor and initial rock speed factor.
@@ -27,23 +40,50 @@ const double ShipPushMult = 0.25, FireRecoilMult = 0.01, AlienPushMult = 1.0, Ro
 // The game logic engine and game object roster
 // ────────────────────────────────────────────
 class Engine {
+   friend class Thing;
+   friend class Bench; // The benchmarks time the phases of _StateTick() one by one.
 private:
-   std::vector<Asteroid::Thing *> _Objects;
-   int _Ticks, _ShipIx, _Lives, _InitRocks;
+   Store _Store; // The object roster, with the data touched every tick held in columns.
+   Pool _Things; // The storage for the objects.
+   Particles _Sparks; // The sparks, debris and thrust.
+// The handle table: each entry holds an object and the generation in which it was issued, or else links to the next free entry.
+   struct HandleT { Thing *Obj; unsigned Gen; int Next; };
+   std::vector<HandleT> _Handles;
+   int _FreeHandle; unsigned _Gen;
+   Handle _ShipH;
+   Grid _Near; std::vector<int> _Solid, _Pairs; // The collision broad phase.
+   Grid _Threats; bool _HasThreats; // The aliens' nearest-threat index.
+   int _AlienCap;
+   int _Census[TypeN], _PeakCensus[TypeN]; // The number of objects of each type in the roster, now and at most, this game.
+   Random _Rand;
+   int _Ticks, _Lives, _InitRocks;
    int _Score, _ExScore, _HiScore;
    int _Xs, _Ys;
-   time_t _NewLifeWait, _EndDemoMark, _EndGameMark;
-   bool _Active, _DiedSnd, _AlienSnd;
-   TypeT _BoomSnd;
+   int _NewLifeWait, _EndDemoMark, _EndGameMark; // By the engine clock.
+   bool _Active;
    double _Level;
+   Recorder *_Rec; // The replay recorder, if the engine's inputs are being recorded.
+   Events *_Events; // The event stream, if anyone is listening.
 #if 0
    void _Bury(); //(@) Not used anywhere.
 #endif
    void _Empty(bool Now);
-   bool _Crash(const Thing &A, const Thing &B) const;
-   void _Boing(const Thing &A, const Thing &B, ObjPos &PosA, ObjPos &PosB) const;
+   void _Free(Thing *Obj);
+   Thing *_Make(TypeT T);
+   Handle _Issue(Thing *Obj);
+   bool _Crash(size_t A, size_t B) const;
+   void _Boing(size_t A, size_t B);
+   void _Collide(size_t N);
+   void _IndexThreats(size_t N);
+   void _IndexThreat(size_t n);
+   void _ResetCensus();
+   size_t _Sweep();
+   void _Move(size_t N);
+   void _TickAll(size_t N);
+   void _Strike(size_t N);
+   void _Spawn();
+   void _WrapAll();
    void _StateTick();
-   int _Types(TypeT T) const;
    Ship *_GetShip() const;
 public:
    Engine();
@@ -53,19 +93,43 @@ public:
    Thing *AddThing(TypeT T);
    Thing *AddThing(TypeT T, const ObjPos &Pos, const ObjPos &Dir = ObjPos());
    Thing *AddKuypier(TypeT T, int Tick);
+   void AddParticle(TypeT T, const ObjPos &Pos, const ObjPos &Dir, double Angle = 0.0);
+   void Emit(EventT Ev, TypeT T, const ObjPos &Pos, int N = 0);
+// The engine's random number generator, which is used by all its objects.
+   Random &GetRandom();
+   void SetSeed(uint64_t Seed);
+   long GetAllocs() const;
+// The replay recorder, which is told of every input made to the engine, and a checksum of the engine's state, for checking replays.
+   Recorder *GetRecorder() const;
+   void SetRecorder(Recorder *Rec);
+   uint64_t Checksum() const;
+// The event stream (Events.h), which is told of everything of note that happens in a tick, as it happens.
+   Events *GetEvents() const;
+   void SetEvents(Events *Evs);
+// Snapshots of the whole engine state (Snapshot.h), to save a game part way through and pick it up again.
+   size_t SaveSize() const;
+   size_t Save(void *Buf, size_t Size) const;
+   bool Restore(const void *Buf, size_t Size);
 // Access internal objects.
 // These are needed in order to render objects onto the screen device.
    size_t ObjN() const;
    Thing *ObjAtN(size_t N) const;
+   Thing *Find(Handle H) const;
+   Thing *NearestThreat(const ObjPos &Pos) const;
+   const Particles &GetParticles() const;
+   size_t ParticleN() const;
+   int Census(TypeT T) const;
+   int PeakCensus(TypeT T) const;
 // State control.
    bool GetActive() const;
    bool InDemo() const;
    bool InGame() const;
    bool EndGame() const;
    void BegGame(int Rocks = 10);
-   void BegDemo(time_t T = 20, int Rocks = 10);
+   void BegDemo(int T = 20, int Rocks = 10);
    void Stop();
    void Tick();
+   int GetTicks() const;
    int GetLives() const;
    int GetScore() const;
    int GetExScore() const;
@@ -75,17 +139,15 @@ public:
    void SetLevel(const double &Level);
 // The game and ship control input.
    void AddAlienCheat();
+   int GetAlienCap() const;
+   void SetAlienCap(int Cap);
    void SetSpin(int Spin);
    void SetPushing(bool Pushing);
    void Fire();
    void ReLoad();
    int Charge() const;
-// The sound flags (poll after calling Tick()).
-   TypeT GetBoomSnd() const;
-   bool GetLanceSnd() const;
+// The thrust sound, which is a state, rather than an event; the other sounds are told by the event stream.
    bool GetThrustSnd() const;
-   bool GetAlienSnd() const;
-   bool GetDiedSnd() const;
 // The game playing area methods.
    void GetPlayDims(int *XsP, int *YsP) const;
    void SetPlayDims(int Xs, int Ys);
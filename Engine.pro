@@ -0,0 +1,67 @@
+## Asteroid Style Game, QT-based makefile for the game engine library
+## (c) 2021 Darth Spectra (Lydia Marie Williamson)
+
+## The engine has no QT or Phonon dependencies, and is built as a static library,
+## so that it may be linked into the game itself (Asteroid.pro) and the headless simulation driver (Simulate.pro).
+## See Asteroid.pro for notes on the QMake variables.
+
+## Configuration
+## Setup:
+TEMPLATE = lib
+CONFIG += staticlib warn_on release
+CONFIG -= qt
+
+## Paths:
+TARGET = AsteroidEngine
+DESTDIR = .
+INCLUDEPATH = .
+MAKEFILE = Makefile.Engine
+
+## Defines:
+win32:DEFINES *= WINDOWS WIN32 UNICODE NO_DEBUG
+#debug:DEFINES *= _DEBUG
+## Make with "qmake CONFIG+=profile" to compile in the profiler (Profile.h), for the engine and the programs alike.
+profile:DEFINES *= PROFILE
+
+## Objects and Temp files:
+debug:OBJECTS_DIR = Temp
+release:OBJECTS_DIR = Temp
+
+## Header Files:
+HEADERS += Engine.h
+HEADERS += Events.h
+HEADERS += Grid.h
+HEADERS += Kernel.h
+HEADERS += Objects.h
+HEADERS += Particles.h
+HEADERS += Pool.h
+HEADERS += Profile.h
+HEADERS += Queue.h
+HEADERS += Random.h
+HEADERS += Replay.h
+HEADERS += Rewind.h
+HEADERS += Shapes.h
+HEADERS += Sim.h
+HEADERS += Snapshot.h
+HEADERS += Store.h
+HEADERS += Stream.h
+HEADERS += Trace.h
+HEADERS += Traits.h
+HEADERS += Triple.h
+
+## Source Files:
+SOURCES += Engine.cpp
+SOURCES += Grid.cpp
+SOURCES += Kernel.cpp
+SOURCES += Objects.cpp
+SOURCES += Particles.cpp
+SOURCES += Pool.cpp
+SOURCES += Profile.cpp
+SOURCES += Random.cpp
+SOURCES += Replay.cpp
+SOURCES += Rewind.cpp
+SOURCES += Shapes.cpp
+SOURCES += Sim.cpp
+SOURCES += Snapshot.cpp
+SOURCES += Store.cpp
+SOURCES += Trace.cpp
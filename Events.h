@@ -0,0 +1,32 @@
+#ifndef OnceOnlyEvents_h
+#define OnceOnlyEvents_h
+
+// Asteroid Style Game: The engine's event stream, which tells of everything of note that happens in the engine's ticks.
+// Copyright (c) 2021 Darth Spectra
+#include "Objects.h"
+#include "Stream.h"
+
+namespace Asteroid {
+// The events: an object blown up, a lance fired, the ship lost, an alien killed, an extra life won, and points scored.
+enum EventT { NoEV = 0, BoomEV, LanceEV, DiedEV, AlienEV, ExtraLifeEV, ScoreEV, EventN };
+
+// An event: the type and position of the object that it befell (the lance, for LanceEV, and the object shot, for ScoreEV),
+// the points scored (for ScoreEV), and the engine clock when it happened.
+struct EventRecT { EventT Event; TypeT Type; ObjPos Pos; int N, Tick; };
+
+// The listeners, each of which drains the stream at its own pace: the sounds, the heads-up display and the telemetry.
+enum ListenerT { AudioLI = 0, HudLI, TelemetryLI, ListenerN };
+
+// The number of events that may be waiting for a listener.
+// The game drains every listener once a poll, in which time the simulation thread runs at most SimCatchUp (4) steps of up to FastTurbo (8) ticks;
+// so the ring holds all of the events of 32 ticks, at up to 128 a tick, where a tick gives one for each object blown up and each lance fired,
+// one for each object shot, with the points and any alien killed or extra life won, and one for the ship lost.
+const size_t EventRing = 1 << 12;
+
+// The event stream: filled by the engine, as its ticks run (Engine::SetEvents()), and drained by the listeners attached to it.
+// The engine never waits on the listeners, nor do they wait on each other: only a listener that falls more than EventRing events behind loses any,
+// the oldest ones that it has not yet taken, which it counts (Lost()); the other listeners still take every event.
+typedef Stream<EventRecT, EventRing, ListenerN> Events;
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -4,7 +4,9 @@
 #include <phonon>
 #include <math.h>
 #include "Game.h"
-#include "Engine.h"
+#include "Profile.h"
+#include "Trace.h"
+#include "Traits.h"
 #include "Version.h"
 
 // QT and phonon changed.
@@ -14,8 +16,22 @@
 #   define PhononFile(Path, File)	(Phonon::MediaSource((Path) + (File)))
 #endif
 
-static const int DefPollRate = 45, IntroScreenTime = 8;
+// The engine's step period and the frame period, in milliseconds: the game is painted about 120 times a second, in between the engine's steps.
+static const int DefPollRate = 45, DefFrameRate = 8, IntroScreenTime = 8;
+// The engine ticks per poll when fast-forwarding.
+static const int FastTurbo = 8;
 static const QString ScreenFontName = "serif";
+// The most text layouts that are cached at once; the cache is started over when it fills up.
+static const int MaxTexts = 256;
+
+// The game control keys, which a replay swallows, since it is driven by its own inputs alone.
+static bool ControlKey(int Key) {
+   switch (Key) {
+      case Qt::Key_K: case Qt::Key_Left: case Qt::Key_L: case Qt::Key_Right:
+      case Qt::Key_A: case Qt::Key_Up: case Qt::Key_Control: case Qt::Key_Space: return true;
+      default: return false;
+   }
+}
 
 // class Game: private members
 // ───────────────────────────
@@ -24,33 +40,59 @@ int Game::_Filler() const { return (int)(5.0*_Scaling()); }
 
 // The scaling value based on the width.
 double Game::_Scaling() const {
-   int Xs; _Machine->GetPlayDims(&Xs, 0);
+   int Xs = _Sim->Scene().Xs;
    return Xs > 0? (double)width()/Xs: 1.0;
 }
 
+// How far the objects are to be drawn back from where they are in the render snapshot S, toward where they were in the one before,
+// as the fraction of the step period that is yet to run until the next snapshot is due: from 1, when S has just been made, down to 0, a period later.
+// So the frames lag a step behind the engine, but glide between its steps, at whatever rate they are painted.
+// There is nothing to glide between when the engine is run freely.
+double Game::_Lag(const Asteroid::SceneT &S) const {
+   if (S.Period <= 0) return 0.0;
+   double Lag = 1.0 - (double)(Asteroid::Sim::Now() - S.Stamp)/S.Period;
+   return Lag < 0.0? 0.0: Lag > 1.0? 1.0: Lag;
+}
+
 // Resize the internal gaming area by adjusting its aspect ratio in such a way as to keep the area approximately constant.
-// This is to be called when the parent's size is changed.
+// This is to be called when the parent's size is changed; the engine is only told when the play area comes out different.
 void Game::_ResizeArena() {
    int Xs = width(), Ys = height();
    if (Ys > 0) {
       double Aspect = (double)Xs/Ys;
-      _Machine->SetPlayDims((int)sqrt(Aspect*_Arena), (int)((double)Xs/Aspect));
+      Xs = (int)sqrt(Aspect*_Arena), Ys = (int)((double)Xs/Aspect);
+      if (Xs != _Xs || Ys != _Ys) _Xs = Xs, _Ys = Ys, _Sim->Send(Asteroid::DimsOR, Xs, Ys);
    }
 }
 
+// Make the fonts afresh for the present scale, if it has changed, and, with them, start the text layouts over.
+void Game::_Rescale() {
+   double Sc = _Scaling();
+   if (Sc == _TextScale) return;
+   _TextScale = Sc;
+   for (int N = 0; N < Asteroid::FontN; N++) {
+      double Pts; bool Bold = false;
+      switch (N) {
+         case Asteroid::SmallLF: Pts = 10; break;
+         case Asteroid::LargeLF: Pts = 14; break;
+         case Asteroid::HugeBoldLF: Pts = 16, Bold = true; break;
+         default: Pts = 12; break;
+      }
+   // Rescale the point size up to a fixed lower limit.
+      if ((Pts *= Sc) < 8) Pts = 8;
+      _Fonts[N] = QFont(ScreenFontName), _Fonts[N].setBold(Bold), _Fonts[N].setPointSizeF(Pts);
+   }
+   _Texts.clear();
+   for (int H = 0; H < HudN; H++) _Hud[H].Value = -1;
+}
+
 // Set the painter font according to size N and boldness Bold.
 void Game::_SetFont(QPainter &Pnt, Asteroid::FontT N, bool Bold/* = false*/) {
-   double Pts;
-   switch (N) {
-      case Asteroid::SmallLF: Pts = 10; break;
-      case Asteroid::LargeLF: Pts = 14; break;
-      case Asteroid::HugeBoldLF: Pts = 16, Bold = true; break;
-      default: Pts = 12; break;
+   _Rescale();
+   if (!Bold || _Fonts[N].bold()) Pnt.setFont(_Fonts[N]);
+   else {
+      QFont Font = _Fonts[N]; Font.setBold(true), Pnt.setFont(Font);
    }
-// Rescale the point size up to a fixed lower limit.
-   if ((Pts *= _Scaling()) < 8) Pts = 8;
-// Set the font.
-   QFont Font = Pnt.font(); Font.setBold(Bold), Font.setPointSizeF(Pts), Pnt.setFont(Font);
 }
 
 // Draw the text out at X, Y; returning the height of the text drawn.
@@ -63,47 +105,138 @@ int Game::_PutStr(QPainter &Pnt, const QString &Str, int X, int Y, Qt::Alignment
    if (LayOut&Qt::AlignRight) X -= R.width(); else if (LayOut&(Qt::AlignHCenter | Qt::AlignCenter)) X -= R.width()/2;
 // Vertical.
    if (LayOut&Qt::AlignBottom) Y -= R.height(); else if (LayOut&(Qt::AlignVCenter | Qt::AlignCenter)) Y -= R.height()/2;
-   Pnt.drawText(QRect(X, Y, R.width(), R.height()), Qt::AlignLeft | Qt::AlignTop, Str);
+   Pnt.drawText(QRect(X, Y, R.width(), R.height()), Qt::AlignLeft | Qt::AlignTop, Str), ProfileCount(Asteroid::DrawsPR, 1);
    return R.height();
 }
 
+// The text Str, translated, and laid out in the font N, at the present scale: laid out only the first time that it is asked for,
+// and then taken from the cache, which is keyed by the font and the string, and started over when the scale changes.
+const QStaticText &Game::_Text(Asteroid::FontT N, const char *Str) {
+   _Rescale();
+   QString Key = QString::fromLatin1(Str); Key.prepend(QChar('0' + N));
+   QHash<QString, QStaticText>::iterator T = _Texts.find(Key);
+   if (T == _Texts.end()) {
+      if (_Texts.size() >= MaxTexts) _Texts.clear();
+      QStaticText Text(tr(Str));
+      Text.setTextFormat(Qt::PlainText), Text.setPerformanceHint(QStaticText::AggressiveCaching), Text.prepare(QTransform(), _Fonts[N]);
+      T = _Texts.insert(Key, Text);
+   }
+   return *T;
+}
+
+// The line H of the heads-up display, showing Value, in the small font: laid out afresh only when the value, or the scale, has changed.
+const QStaticText &Game::_HudText(HudT H, int Value) {
+   _Rescale();
+   HudLineT &L = _Hud[H];
+   if (L.Value != Value) {
+      QString Str;
+      switch (H) {
+         case ScoreHU: Str = tr("SCORE ") + QString::number(Value); break;
+         case GainHU: Str = QString("  +%1").arg(Value); break;
+         case LivesHU: Str = tr("LIVES ") + QString::number(Value); break;
+         case HiScoreHU: Str = tr("HI SCORE ") + QString::number(Value); break;
+         default: Str = QString(Value, '|'); break;
+      }
+      L.Value = Value, L.Text.setText(Str);
+      L.Text.setTextFormat(Qt::PlainText), L.Text.setPerformanceHint(QStaticText::AggressiveCaching), L.Text.prepare(QTransform(), _Fonts[Asteroid::SmallLF]);
+   }
+   return L.Text;
+}
+
+// Draw the laid-out text Text, in the font N, at X, Y, aligned as for _PutStr(); returning the height of the text drawn.
+// Nothing is laid out here: the size of the text is the one taken when it was laid out.
+int Game::_PutText(QPainter &Pnt, Asteroid::FontT N, const QStaticText &Text, int X, int Y, Qt::Alignment LayOut) {
+   QSizeF R = Text.size();
+// Horizontal.
+   if (LayOut&Qt::AlignRight) X -= (int)R.width(); else if (LayOut&(Qt::AlignHCenter | Qt::AlignCenter)) X -= (int)R.width()/2;
+// Vertical.
+   if (LayOut&Qt::AlignBottom) Y -= (int)R.height(); else if (LayOut&(Qt::AlignVCenter | Qt::AlignCenter)) Y -= (int)R.height()/2;
+   Pnt.setFont(_Fonts[N]), Pnt.drawStaticText(X, Y, Text), ProfileCount(Asteroid::DrawsPR, 1);
+   return (int)R.height();
+}
+
 // Render a blank painter and set up the colors.
 void Game::_ResetScreen(QPainter &Pnt) {
    Pnt.setFont(QFont(ScreenFontName)), Pnt.setPen(QPen(_ColorFg)), Pnt.fillRect(rect(), _ColorBg);
 }
 
 // Draw the play action, including the demo phase, during active game play or demo mode to render the game engine objects.
+// Everything is drawn from the latest render snapshot taken from the simulation thread (Sim.h), never from the engine itself.
+// The objects' outlines and the particles are drawn first, then their labels over them, so that each part of the frame may be profiled on its own.
+// The outlines and particles all share the one pen, so their line segments are transformed onto the screen in one pass over the snapshot's buffer,
+// a plain loop over contiguous coordinates, which the compiler may vectorize, and drawn with one call; the draw calls of each frame are counted.
 void Game::_ShowPlay() {
+   Profiled(Asteroid::FramePR);
    QPainter Pnt(this); _ResetScreen(Pnt);
-   double Sc = _Scaling();
-   for (size_t Ox = 0; Ox < _Machine->ObjN(); Ox++) {
-   // For each live game object.
-   // Get a reference to the game object.
-      Asteroid::Thing *Obj = _Machine->ObjAtN(Ox); if (Obj->GetDead()) continue;
-   // Draw the shape, if there is one.
-      int N = Obj->GetPoints();
-      if (N > 0) {
-         int X0 = (int)(Sc*Obj->PosPoints(0).real()), Y0 = (int)(Sc*Obj->PosPoints(0).imag());
-         for (int n = 1; n < N; n++) {
-            int X = (int)(Sc*Obj->PosPoints(n).real()), Y = (int)(Sc*Obj->PosPoints(n).imag());
-            Pnt.drawLine(X0, Y0, X, Y), X0 = X, Y0 = Y;
-         }
+   const Asteroid::SceneT &S = _Sim->Scene();
+   double Sc = _Scaling(), Lag = _Lagged = _Lag(S);
+   {
+      Profiled(Asteroid::GeometryPR);
+   // Transform every end point, drawn back by its share of the lag, and scaled onto the screen.
+      int N = (int)S.Lines.size();
+      _Verts.resize(N);
+      const Asteroid::ObjPos *P = S.Lines.data(), *D = S.Shifts.data(); QPointF *V = _Verts.data();
+      for (int n = 0; n < N; n++) V[n] = QPointF(Sc*(P[n].real() - Lag*D[n].real()), Sc*(P[n].imag() - Lag*D[n].imag()));
+   // Draw the outlines and the particles, all in one batch.
+      if (N > 1) Pnt.drawLines(V, N/2), ProfileCount(Asteroid::DrawsPR, 1);
+   }
+   {
+      Profiled(Asteroid::TextPR);
+   // Add the labels, from the text layout cache.
+      for (size_t Cx = 0; Cx < S.Captions.size(); Cx++) {
+         const Asteroid::CaptionT &C = S.Captions[Cx];
+         Asteroid::ObjPos Pos = C.Pos - Lag*C.Shift;
+         _PutText(Pnt, C.Pts, _Text(C.Pts, C.Text), (int)(Sc*Pos.real()), (int)(Sc*Pos.imag()), Qt::AlignCenter);
       }
-   // Add the labels.
-      QString Str = tr(Obj->GetCaption().c_str());
-   // Draw the new position, if there is one.
-      if (!Str.isEmpty())
-         _SetFont(Pnt, Obj->GetPts()),
-         _PutStr(Pnt, Str, (int)(Sc*Obj->_Pos.real()), (int)(Sc*Obj->_Pos.imag()), Qt::AlignCenter);
    }
-// Indicate paused, if applicable.
-   if (_Pausing) _SetFont(Pnt, Asteroid::SmallLF), _PutStr(Pnt, tr("PAUSED"), width()/2, height()/2, Qt::AlignCenter);
-// Mark the scores and lives.
+   {
+      Profiled(Asteroid::HudPR);
+      const Asteroid::FontT Small = Asteroid::SmallLF;
+   // Indicate paused, if applicable.
+      if (_Pausing) _PutText(Pnt, Small, _Text(Small, "PAUSED"), width()/2, height()/2, Qt::AlignCenter);
+   // Mark the scores and lives, each of which is laid out afresh only when it changes.
+      const QStaticText &Score = _HudText(ScoreHU, S.Score);
+      int Sh = _PutText(Pnt, Small, Score, _Filler(), _Filler());
+   // The points scored lately are shown beside the score, for a second after the latest.
+      if (_Gain > 0 && S.Ticks >= _GainTick && S.Ticks - _GainTick < Asteroid::TickRate)
+         _PutText(Pnt, Small, _HudText(GainHU, _Gain), _Filler() + (int)Score.size().width(), _Filler());
+      _PutText(Pnt, Small, _HudText(LivesHU, S.Lives), _Filler(), _Filler() + Sh);
+      _PutText(Pnt, Small, _HudText(HiScoreHU, S.HiScore), width() - _Filler(), _Filler(), Qt::AlignRight);
+      if (S.Charge > 0) _PutText(Pnt, Small, _HudText(ChargeHU, S.Charge), _Filler(), height() - _Filler(), Qt::AlignBottom);
+   }
+#ifdef PROFILE
+   if (_Debugging) _ShowProfile(Pnt);
+#endif
+}
+
+// Draw the profiler's overlay, down the right-hand side, below the high score:
+// the frame and tick times and those of their parts, as rolling percentiles in microseconds,
+// the collision pairs tested per tick, and the number of objects (and particles) of each type in play.
+// The overlay is drawn after the frame has been timed, so as not to count itself.
+void Game::_ShowProfile(QPainter &Pnt) {
+   static const char *const TypeName[Asteroid::TypeN] = {
+      "none", "boulder", "stone", "pebble", "ship", "alien", "lance", "debris", "spark", "thrust", "label"
+   };
+// The engine's probes are taken from the snapshot, the game's from this thread's own profiler.
+   const Asteroid::SceneT &S = _Sim->Scene();
+   Asteroid::PercentilesT Frame; Frame.Take(Asteroid::Profiler());
    _SetFont(Pnt, Asteroid::SmallLF);
-   int Sh = _PutStr(Pnt, tr("SCORE ") + QString::number(_Machine->GetScore()), _Filler(), _Filler());
-   _PutStr(Pnt, tr("LIVES ") + QString::number(_Machine->GetLives()), _Filler(), _Filler() + Sh);
-   Sh = _PutStr(Pnt, tr("HI SCORE ") + QString::number(_Machine->GetHiScore()), width() - _Filler(), _Filler(), Qt::AlignRight);
-   _PutStr(Pnt, QString(_Machine->Charge(), '|'), _Filler(), height() - _Filler(), Qt::AlignBottom);
+   int X = width() - _Filler(), Y = 4*_Filler() + Pnt.fontMetrics().height();
+   Y += _PutStr(Pnt, tr("p50 / p95 / p99 (us)"), X, Y, Qt::AlignRight);
+   for (int P = Asteroid::TickPR; P < Asteroid::ProbeN; P++) {
+      Asteroid::ProbeT Pr = (Asteroid::ProbeT)P;
+      const Asteroid::PercentilesT &Prof = Pr <= Asteroid::WrapPR || Pr == Asteroid::PairsPR? S.Prof: Frame;
+      double Scale = Pr >= Asteroid::PairsPR? 1.0: 1.0e-3;
+      Y += _PutStr(Pnt,
+         QString("%1 %2 / %3 / %4").arg(Asteroid::Profile::Name(Pr))
+            .arg(Scale*Prof.P50[Pr], 0, 'f', 1).arg(Scale*Prof.P95[Pr], 0, 'f', 1).arg(Scale*Prof.P99[Pr], 0, 'f', 1),
+         X, Y, Qt::AlignRight
+      );
+   }
+   for (int T = Asteroid::NoOT + 1; T < Asteroid::TypeN; T++) {
+      int N = S.Census[T];
+      if (N > 0) Y += _PutStr(Pnt, QString("%1 %2").arg(TypeName[T]).arg(N), X, Y, Qt::AlignRight);
+   }
 }
 
 // Draw intro screen #0.
@@ -151,6 +284,11 @@ void Game::_ShowIntro1() {
    Y += _PutStr(Pnt, tr("UP ARROW (or A) - Thrust"), Xs/2, Y, Qt::AlignHCenter);
    Y += _PutStr(Pnt, tr("CTRL (or SPACE) - Fire"), Xs/2, Y, Qt::AlignHCenter);
    Y += _PutStr(Pnt, tr("P - Pause"), Xs/2, Y, Qt::AlignHCenter);
+   Y += _PutStr(Pnt, tr("F - Toggle Fast-Forward"), Xs/2, Y, Qt::AlignHCenter);
+   Y += _PutStr(Pnt, tr("R - Rewind (hold)"), Xs/2, Y, Qt::AlignHCenter);
+#ifdef PROFILE
+   Y += _PutStr(Pnt, tr("D - Toggle Profiler Overlay"), Xs/2, Y, Qt::AlignHCenter);
+#endif
    Y += _PutStr(Pnt, tr("ESC - Quit Game"), Xs/2, Y, Qt::AlignHCenter);
    Y += _PutStr(Pnt, tr(" "), Xs/2, Y, Qt::AlignHCenter);
    Y += _PutStr(Pnt, tr("S - Toggle Game Sounds ") + tr(_Sounding? "(ON)": "(OFF)"), Xs/2, Y, Qt::AlignHCenter);
@@ -179,8 +317,8 @@ void Game::_ShowIntro2() {
    _SetFont(Pnt, Asteroid::HugeBoldLF);
    Y += 3*_PutStr(Pnt, AppName.toUpper(), Xs/2, Y, Qt::AlignHCenter);
    _SetFont(Pnt, Asteroid::MediumLF);
-   Y += _PutStr(Pnt, tr("HIGHEST SCORE : ") + QString::number(_Machine->GetHiScore()), Xs/2, Y, Qt::AlignHCenter);
-   Y += _PutStr(Pnt, tr("LAST SCORE : ") + QString::number(_Machine->GetExScore()), Xs/2, Y, Qt::AlignHCenter);
+   Y += _PutStr(Pnt, tr("HIGHEST SCORE : ") + QString::number(_Sim->Scene().HiScore), Xs/2, Y, Qt::AlignHCenter);
+   Y += _PutStr(Pnt, tr("LAST SCORE : ") + QString::number(_Sim->Scene().ExScore), Xs/2, Y, Qt::AlignHCenter);
 // The copyright string from the bottom of the page.
    int Yh = Y;
    Y = Ys - _Filler();
@@ -196,39 +334,81 @@ void Game::_ShowIntro2() {
    if (dY < Y - Yh) _PutStr(Pnt, tr("Press SPACE to Play"), Xs/2, Yh + (Y - Yh - dY)/2, Qt::AlignHCenter);
 }
 
+// The engine's listeners
+// ───────────────────────
+// Each drains its own cursor into the engine's event stream (Events.h), every poll, so that none of them ever holds the stream up.
+// The sounds: play those of the events since the last poll, if Sounding, or else let them go.
+// The explosions share a player, so only the heaviest rock blown up is sounded, as are the alien killed and the ship lost, of which the latter wins.
+void Game::_HearSounds(const QString &Path, bool Sounding) {
+   Profiled(Asteroid::SoundPR); Traced(Asteroid::SoundPR);
+   Asteroid::TypeT Boom = Asteroid::NoOT; bool Lance = false, Alien = false, Died = false;
+   for (Asteroid::EventRecT Ev; _Sim->GetEvents().Pop(Asteroid::AudioLI, Ev); )
+      switch (Ev.Event) {
+         case Asteroid::BoomEV:
+            if (Asteroid::RockyOf(Ev.Type) && (Boom == Asteroid::NoOT || Asteroid::MassOf(Ev.Type) > Asteroid::MassOf(Boom))) Boom = Ev.Type;
+         break;
+         case Asteroid::LanceEV: Lance = true; break;
+         case Asteroid::AlienEV: Alien = true; break;
+         case Asteroid::DiedEV: Died = true; break;
+         default: break;
+      }
+   if (!Sounding) return;
+   switch (Boom) {
+      case Asteroid::BoulderOT:
+         _BoomWav->setCurrentSource(PhononFile(Path, "Boom.wav")), _BoomWav->play();
+      break;
+      case Asteroid::StoneOT:
+         _BoomWav->setCurrentSource(PhononFile(Path, "Blast.wav")), _BoomWav->play();
+      break;
+      case Asteroid::PebbleOT:
+         _BoomWav->setCurrentSource(PhononFile(Path, "Pop.wav")), _BoomWav->play();
+      break;
+      default: break;
+   }
+   if (Lance) _FireWav->setCurrentSource(PhononFile(Path, "Fire.wav")), _FireWav->play();
+   if (Alien) _EventWav->setCurrentSource(PhononFile(Path, "Alien.wav")), _EventWav->play();
+   if (Died) _EventWav->setCurrentSource(PhononFile(Path, "Die.wav")), _EventWav->play();
+}
+
+// The heads-up display: gather the points scored, a second's worth at a time, to be shown beside the score.
+void Game::_HearHud() {
+   for (Asteroid::EventRecT Ev; _Sim->GetEvents().Pop(Asteroid::HudLI, Ev); )
+      if (Ev.Event == Asteroid::ScoreEV) {
+         if (Ev.Tick < _GainTick || Ev.Tick - _GainTick >= Asteroid::TickRate) _Gain = 0;
+         _Gain += Ev.N, _GainTick = Ev.Tick;
+      }
+}
+
+// The telemetry: count the events of each kind, and the points scored, and trace the counts that have changed, as counters.
+void Game::_HearTelemetry() {
+   static const char *const EventName[Asteroid::EventN] = { "none", "booms", "lances", "deaths", "alien kills", "extra lives", "points" };
+   bool Changed[Asteroid::EventN] = { false };
+   for (Asteroid::EventRecT Ev; _Sim->GetEvents().Pop(Asteroid::TelemetryLI, Ev); )
+      _Told[Ev.Event] += Ev.Event == Asteroid::ScoreEV? Ev.N: 1, Changed[Ev.Event] = true;
+   for (int E = Asteroid::NoEV + 1; E < Asteroid::EventN; E++) if (Changed[E]) TraceCount(EventName[E], _Told[E]);
+}
+
 // class Game: private slots
 // ─────────────────────────
 // Internal poller.
-// Called repeatedly to update the game state; also responsible for paging through the intro screens.
+// Called once a frame to update the game state; also responsible for paging through the intro screens.
 void Game::_Poll() {
+   Profiled(Asteroid::PollPR); Traced(Asteroid::PollPR);
 // The media file's pathname.
    const QString Path = QCoreApplication::applicationDirPath() + "/Media/";
-   if (_Machine->GetActive()) {
-   // The game is active, i.e. in play or showing a demo.
-   // Update the game state for the next poll, if active.
-      if (!_Pausing) _Machine->Tick();
-   // Move directly to the intro screen at the end of the game,
-   // otherwise repaint the updated state coming from the last Tick() call.
-      if (_Machine->EndGame()) SetState(Intro0Q); else update();
-      if (_Sounding && _Machine->InGame()) {
-         switch (_Machine->GetBoomSnd()) {
-            case Asteroid::BoulderOT:
-               _BoomWav->setCurrentSource(PhononFile(Path, "Boom.wav")), _BoomWav->play();
-            break;
-            case Asteroid::StoneOT:
-               _BoomWav->setCurrentSource(PhononFile(Path, "Blast.wav")), _BoomWav->play();
-            break;
-            case Asteroid::PebbleOT:
-               _BoomWav->setCurrentSource(PhononFile(Path, "Pop.wav")), _BoomWav->play();
-            break;
-            default: break;
-         }
-         if (_Machine->GetLanceSnd()) _FireWav->setCurrentSource(PhononFile(Path, "Fire.wav")), _FireWav->play();
-         if (!_Machine->GetThrustSnd()) _ThrustWav->stop();
+// The engine runs on its own thread (Sim.h), and the poll takes its latest render snapshot, if there is a new one.
+   bool Fresh = _Sim->Fetch();
+   const Asteroid::SceneT &S = _Sim->Scene();
+   if (_Replaying || S.Active) {
+   // The game is active, i.e. in play or showing a demo, or a replay is being played.
+   // Move directly to the intro screen at the end of the game (or the replay), once the snapshot is of the latest state ordered,
+   // otherwise repaint the updated state coming from the new snapshot, or the motion in between it and the one before, until it has caught up.
+      if (S.Seq >= _StateSeq && (_Replaying? S.Done: S.EndGame)) SetState(Intro0Q); else if (Fresh || _Lagged > 0.0) update();
+   // The thrust is a state, held in the snapshot, rather than an event.
+      if (Fresh && _Sounding && S.InGame) {
+         if (!S.ThrustSnd) _ThrustWav->stop();
          else if (_ThrustWav->state() != Phonon::PlayingState && _ThrustWav->state() != Phonon::BufferingState)
             _ThrustWav->setCurrentSource(PhononFile(Path, "Thrust.wav")), _ThrustWav->play();
-         if (_Machine->GetAlienSnd()) _EventWav->setCurrentSource(PhononFile(Path, "Alien.wav")), _EventWav->play();
-         if (_Machine->GetDiedSnd()) _EventWav->setCurrentSource(PhononFile(Path, "Die.wav")), _EventWav->play();
       }
    } else if (time(0) >= _Time0 + IntroScreenTime)
    // Rotate the intro screens, including any change from the intro to the demo state.
@@ -238,28 +418,33 @@ void Game::_Poll() {
          case Intro2Q: SetState(DemoQ); break;
          default: SetState(Intro0Q); break;
       }
+// Hear out the engine's events, each listener in turn.
+   _HearSounds(Path, _Sounding && S.InGame), _HearHud(), _HearTelemetry();
 // Start the music, change the track or stop the music.
-   if (_Singing && (_Playing != _Machine->InGame() || (_MusicWav->state() != Phonon::BufferingState && _MusicWav->state() != Phonon::PlayingState)))
-      _MusicWav->setCurrentSource(PhononFile(Path, _Machine->InGame()? "Play.mp3": "Intro.mp3")), _MusicWav->play();
+   if (_Singing && (_Playing != S.InGame || (_MusicWav->state() != Phonon::BufferingState && _MusicWav->state() != Phonon::PlayingState)))
+      _MusicWav->setCurrentSource(PhononFile(Path, S.InGame? "Play.mp3": "Intro.mp3")), _MusicWav->play();
    else if (!_Singing && _MusicWav->state() == Phonon::PlayingState)
       _MusicWav->stop();
 // Stop any lingering sounds.
-   if ((!_Sounding || !_Machine->InGame()) && _ThrustWav->state() == Phonon::PlayingState) _ThrustWav->stop();
+   if ((!_Sounding || !S.InGame) && _ThrustWav->state() == Phonon::PlayingState) _ThrustWav->stop();
 // Hold the last state to detect any change.
-   _Playing = _Machine->InGame();
+   _Playing = S.InGame;
 }
 
 // class Game: protected members
 // ─────────────────────────────
-// The paint event handler: call the appropriate rendering method.
+// The paint event handler: call the appropriate rendering method, and take the count of the draw calls that it made (the overlay's among them).
 void Game::paintEvent(QPaintEvent * /*Ev*/) {
-   _ResizeArena();
+   Profiled(Asteroid::PaintPR); Traced(Asteroid::PaintPR);
+// A replay keeps the play area that it was recorded with.
+   if (!_Replaying) _ResizeArena();
    switch (_State) {
       case Intro0Q: _ShowIntro0(); break;
       case Intro1Q: _ShowIntro1(); break;
       case Intro2Q: _ShowIntro2(); break;
       default: _ShowPlay(); break;
    }
+   ProfileTally(Asteroid::DrawsPR);
 }
 
 // class Game: public members
@@ -267,34 +452,50 @@ void Game::paintEvent(QPaintEvent * /*Ev*/) {
 // Make a new Game object.
 Game::Game(QWidget *Sup): QWidget(Sup, Qt::Widget) {
    _Pausing = false, _Sounding = true, _Singing = true, _Playing = false;
-   _EnSound = false, _EnMusic = false, _EnPause = false;
+   _EnSound = false, _EnMusic = false, _EnPause = false, _EnTurbo = false, _EnDebug = false, _EnRewind = false, _Turbo = 1;
+   _Debugging = false, _Replaying = false, _StateSeq = 0;
    _ColorFg = Qt::white, _ColorBg = Qt::black;
    _State = Intro0Q, _Time0 = time(0);
+   _Verts.reserve(16*(Asteroid::MaxObjs + Asteroid::MaxParticles));
+   _TextScale = 0.0;
+   for (int H = 0; H < HudN; H++) _Hud[H].Value = -1;
+   _Gain = 0, _GainTick = 0;
+   for (int E = 0; E < Asteroid::EventN; E++) _Told[E] = 0;
 // Create the media players.
    _MusicWav = Phonon::createPlayer(Phonon::MusicCategory, Phonon::MediaSource());
    _BoomWav = Phonon::createPlayer(Phonon::GameCategory, Phonon::MediaSource());
    _ThrustWav = Phonon::createPlayer(Phonon::GameCategory, Phonon::MediaSource());
    _FireWav = Phonon::createPlayer(Phonon::GameCategory, Phonon::MediaSource());
    _EventWav = Phonon::createPlayer(Phonon::GameCategory, Phonon::MediaSource());
-// Set up the game engine.
-   _Machine = new Asteroid::Engine();
-   int Xs, Ys; _Machine->GetPlayDims(&Xs, &Ys);
-   _Arena = Xs*Ys, _ResizeArena();
+// Set up the game engine, on its own thread, stepping once every poll period.
+   _Sim = new Asteroid::Sim();
+   Asteroid::Engine &Machine = _Sim->GetEngine(); Machine.SetSeed(time(0));
+   Machine.GetPlayDims(&_Xs, &_Ys), _Level = Machine.GetLevel();
+// -play File: play the replay in File back, in place of the intro screens; -record File: record the game's inputs into a replay in File.
+   QStringList Args = QCoreApplication::arguments();
+   for (int A = 1; A + 1 < Args.size(); A++)
+      if (Args[A] == "-play" && _Sim->Play(Args[A + 1].toLocal8Bit().constData())) _Replaying = true, _State = DemoQ;
+   for (int A = 1; A + 1 < Args.size() && !_Replaying; A++)
+      if (Args[A] == "-record") _Sim->Record(Args[A + 1].toLocal8Bit().constData());
+   for (int L = 0; L < Asteroid::ListenerN; L++) _Sim->GetEvents().Attach(L);
+   _PollRate = DefPollRate, _Lagged = 0.0;
+   _Sim->Start(1000*_PollRate), _Sim->Fetch();
+   _Arena = _Xs*_Ys, _ResizeArena();
 // Set up the poll timer.
-   _Timer = new QTimer(this), connect(_Timer, SIGNAL(timeout()), this, SLOT(_Poll())), _Timer->start(DefPollRate);
+   _Timer = new QTimer(this), connect(_Timer, SIGNAL(timeout()), this, SLOT(_Poll())), _Timer->start(DefFrameRate);
 }
 
 // Free the Game object.
 Game::~Game() {
    try {
-      delete _Machine; delete _MusicWav; delete _BoomWav;
+      delete _Sim; delete _MusicWav; delete _BoomWav;
       delete _ThrustWav; delete _FireWav; delete _EventWav;
    } catch(...) { }
 }
 
 // Get/set the game-pause state.
 bool Game::GetPausing() const { return _Pausing; }
-void Game::SetPausing(bool Pausing) { _Pausing = Pausing && GetPlaying(); }
+void Game::SetPausing(bool Pausing) { _Pausing = Pausing && (GetPlaying() || _Replaying), _Sim->Send(Asteroid::PauseOR, _Pausing); }
 
 // Get/set the game-playing state.
 bool Game::GetPlaying() const { return GetState() == PlayQ; }
@@ -310,10 +511,11 @@ Game::StateT Game::GetState() const { return _State; }
 void Game::SetState(Game::StateT State) {
    if (State != _State) {
    // Start engine playing, engine demo or kill play/demo.
+   // The engine takes the order on its own thread, and the snapshots from before it are not to be taken as the state ordered.
       switch (State) {
-         case PlayQ: _Pausing = false, _Machine->BegGame(); break;
-         case DemoQ: _Machine->BegDemo(); break;
-         default: _Pausing = false, _Machine->Stop(); break;
+         case PlayQ: _Pausing = false, _StateSeq = _Sim->Send(Asteroid::BegGameOR, 10); break;
+         case DemoQ: _StateSeq = _Sim->Send(Asteroid::BegDemoOR, 20, 10); break;
+         default: _Pausing = false, _Replaying = false, _StateSeq = _Sim->Send(Asteroid::StopOR); break;
       }
    // Update the state and hold the time when it was done.
       _State = State, _Time0 = time(0), update();
@@ -321,8 +523,8 @@ void Game::SetState(Game::StateT State) {
 }
 
 // Get/set the high score.
-int Game::GetHiScore() const { return _Machine->GetHiScore(); }
-void Game::SetHiScore(int Score) { _Machine->SetHiScore(Score); }
+int Game::GetHiScore() const { return _Sim->Scene().HiScore; }
+void Game::SetHiScore(int Score) { _Sim->Send(Asteroid::HiScoreOR, Score); }
 
 // Get/set the sounding/singing states; foreground/background colors.
 // Update the intro pages after any change is made.
@@ -345,28 +547,36 @@ void Game::SetColorBg(const QColor &ColorBg) {
 
 // Get/set the game level.
 // The level ∈ [0,1] determines how fast rocks are created; 0 = easiest, 1 = hardest.
-double Game::GetLevel() const { return _Machine->GetLevel(); }
-void Game::SetLevel(const double &Level) { _Machine->SetLevel(Level); }
+double Game::GetLevel() const { return _Level; }
+void Game::SetLevel(const double &Level) { _Level = Level, _Sim->Send(Asteroid::LevelOR, 0, 0, Level); }
+
+// Get/set the game speed; i.e. the engine's step period, in milliseconds; the frames are painted on their own timer, in between.
+int Game::GetPollRate() const { return _PollRate; }
+void Game::SetPollRate(int PollRate) { _PollRate = PollRate, _Sim->Send(Asteroid::PeriodOR, 1000*PollRate); }
 
-// Get/set the game speed; i.e. the polling rate, which is in milliseconds.
-int Game::GetPollRate() const { return _Timer->interval(); }
-void Game::SetPollRate(int PollRate) { _Timer->setInterval(PollRate); }
+// Get/set the number of engine ticks run on each step: 1 for normal play, more for fast-forward.
+// The engine times everything by its own clock, so this speeds up the whole game, including its pauses and labels.
+int Game::GetTurbo() const { return _Turbo; }
+void Game::SetTurbo(int Turbo) { _Turbo = Turbo < 1? 1: Turbo, _Sim->Send(Asteroid::TurboOR, _Turbo); }
 
 // Handle a key down event; meant to be called from outside this class in response to key events.
 // Return true if handled.
 bool Game::EnKey(int Key) {
+   if (_Replaying && ControlKey(Key)) return true;
    switch (Key) {
    // Game control keys down.
-      case Qt::Key_K: case Qt::Key_Left: _Machine->SetSpin(-1); return true;
-      case Qt::Key_L: case Qt::Key_Right: _Machine->SetSpin(+1); return true;
-      case Qt::Key_A: case Qt::Key_Up: _Machine->SetPushing(true); return true;
-      case Qt::Key_Control: case Qt::Key_Space: _Machine->Fire(); return true;
+      case Qt::Key_K: case Qt::Key_Left: _Sim->Send(Asteroid::SpinOR, -1); return true;
+      case Qt::Key_L: case Qt::Key_Right: _Sim->Send(Asteroid::SpinOR, +1); return true;
+      case Qt::Key_A: case Qt::Key_Up: _Sim->Send(Asteroid::PushOR, true); return true;
+      case Qt::Key_Control: case Qt::Key_Space: _Sim->Send(Asteroid::FireOR); return true;
 #if 0
    // Start game key down: start the game.
       case Qt::Key_Space: SetPlaying(true); return true;
 #endif
-   // Stop game key down: stop the game.
-      case Qt::Key_Escape: SetPlaying(false); return true;
+   // Stop game key down: stop the game, or the replay.
+      case Qt::Key_Escape:
+         if (_Replaying) SetState(Intro0Q); else SetPlaying(false);
+      return true;
    // Sound key down: toggle the sound state.
       case Qt::Key_S:
          if (!_EnSound) SetSounding(!_Sounding), _EnSound = true;
@@ -379,6 +589,20 @@ bool Game::EnKey(int Key) {
       case Qt::Key_P:
          if (!_EnPause) SetPausing(!_Pausing), _EnPause = true;
       return true;
+   // Fast-forward key down: toggle the fast-forward state.
+      case Qt::Key_F:
+         if (!_EnTurbo) SetTurbo(_Turbo > 1? 1: FastTurbo), _EnTurbo = true;
+      return true;
+   // Rewind key down: go back through the game, while it is held; not in a replay, or while recording one, which the engine sees to.
+      case Qt::Key_R:
+         if (!_EnRewind) _Sim->Send(Asteroid::RewindOR, true), _EnRewind = true;
+      return true;
+#ifdef PROFILE
+   // Debug key down: toggle the profiler's overlay.
+      case Qt::Key_D:
+         if (!_EnDebug) _Debugging = !_Debugging, _EnDebug = true;
+      return true;
+#endif
    }
    return false;
 }
@@ -386,12 +610,13 @@ bool Game::EnKey(int Key) {
 // Handle a key up event; meant to be called from outside this class in response to key events.
 // Return true if handled.
 bool Game::DeKey(int Key) {
+   if (_Replaying && ControlKey(Key)) return true;
    switch (Key) {
    // Game control keys up.
-      case Qt::Key_K: case Qt::Key_Left: _Machine->SetSpin(0); return true;
-      case Qt::Key_L: case Qt::Key_Right: _Machine->SetSpin(0); return true;
-      case Qt::Key_A: case Qt::Key_Up: _Machine->SetPushing(false); return true;
-      case Qt::Key_Control: case Qt::Key_Space: _Machine->ReLoad(); return true;
+      case Qt::Key_K: case Qt::Key_Left: _Sim->Send(Asteroid::SpinOR, 0); return true;
+      case Qt::Key_L: case Qt::Key_Right: _Sim->Send(Asteroid::SpinOR, 0); return true;
+      case Qt::Key_A: case Qt::Key_Up: _Sim->Send(Asteroid::PushOR, false); return true;
+      case Qt::Key_Control: case Qt::Key_Space: _Sim->Send(Asteroid::ReLoadOR); return true;
 #if 0
    // Start game key up.
       case Qt::Key_Space: return true;
@@ -404,6 +629,14 @@ bool Game::DeKey(int Key) {
       case Qt::Key_M: _EnMusic = false; return true;
    // Pause key up.
       case Qt::Key_P: _EnPause = false; return true;
+   // Fast-forward key up.
+      case Qt::Key_F: _EnTurbo = false; return true;
+   // Rewind key up: carry on from where the rewind stopped.
+      case Qt::Key_R: _EnRewind = false, _Sim->Send(Asteroid::RewindOR, false); return true;
+#ifdef PROFILE
+   // Debug key up.
+      case Qt::Key_D: _EnDebug = false; return true;
+#endif
    }
    return false;
 }
@@ -6,7 +6,12 @@
 #include <time.h>
 #include <QWidget>
 #include <QColor>
-#include "Engine.h"
+#include <QFont>
+#include <QHash>
+#include <QPointF>
+#include <QStaticText>
+#include <QVector>
+#include "Sim.h"
 
 class QTimer;
 class QPainter;
@@ -21,26 +26,54 @@ public:
 // The game state.
    typedef enum { Intro0Q = 0, Intro1Q = 1, Intro2Q = 2, PlayQ = 3, DemoQ = 4 } StateT;
 private:
+// The lines of the heads-up display: the score, the points scored lately, the lives, the high score and the fire charge.
+   typedef enum { ScoreHU = 0, GainHU, LivesHU, HiScoreHU, ChargeHU, HudN } HudT;
+// A line of the heads-up display, with the value that it was laid out for, or -1 if it has yet to be.
+   struct HudLineT { int Value; QStaticText Text; };
    bool _Pausing, _Sounding, _Singing, _Playing;
-   bool _EnPause, _EnSound, _EnMusic;
+   bool _EnPause, _EnSound, _EnMusic, _EnTurbo, _EnDebug, _EnRewind;
+   bool _Debugging; // Show the profiler's overlay (only when it is compiled in).
+   bool _Replaying; // Play a replay back, in place of the game.
+   int _Turbo;
    time_t _Time0;
    double _Arena;
    StateT _State;
    QColor _ColorFg, _ColorBg;
-   QTimer *_Timer;
-   Asteroid::Engine *_Machine;
+   QTimer *_Timer; // The frame timer, which polls and paints far more often than the engine steps.
+   int _PollRate; // The engine's step period, in milliseconds.
+   double _Lagged; // How far the last frame painted was drawn back toward the snapshot before, as a fraction of a step.
+   Asteroid::Sim *_Sim; // The engine, run on a thread of its own, and its render snapshots.
+   long _StateSeq; // The number of the latest order to the engine that changed the game's state.
+   int _Xs, _Ys; // The play area last ordered.
+   double _Level;
+   double _TextScale; // The scale that the fonts and the text layouts were made for.
+   QFont _Fonts[Asteroid::FontN];
+   QHash<QString, QStaticText> _Texts; // The text layout cache, keyed by font and string.
+   HudLineT _Hud[HudN];
+   QVector<QPointF> _Verts; // The end points of the line segments of the frame, transformed onto the screen, in pairs, for drawing in one batch.
+   int _Gain, _GainTick; // The points scored lately, shown beside the score, and the engine clock when the latest were.
+   long _Told[Asteroid::EventN]; // The events of each kind (the points, for ScoreEV) told so far, for the trace.
 // Sound players
    Phonon::MediaObject *_MusicWav, *_BoomWav, *_ThrustWav, *_FireWav, *_EventWav;
    int _Filler() const;
    double _Scaling() const;
+   double _Lag(const Asteroid::SceneT &S) const;
    void _ResizeArena();
+   void _Rescale();
    void _SetFont(QPainter &Pnt, Asteroid::FontT N, bool Bold = false);
    int _PutStr(QPainter &Pnt, const QString &Str, int X, int Y, Qt::Alignment Grid = Qt::AlignLeft | Qt::AlignTop);
+   const QStaticText &_Text(Asteroid::FontT N, const char *Str);
+   const QStaticText &_HudText(HudT H, int Value);
+   int _PutText(QPainter &Pnt, Asteroid::FontT N, const QStaticText &Text, int X, int Y, Qt::Alignment Grid = Qt::AlignLeft | Qt::AlignTop);
    void _ResetScreen(QPainter &Pnt);
    void _ShowPlay();
+   void _ShowProfile(QPainter &Pnt);
    void _ShowIntro0();
    void _ShowIntro1();
    void _ShowIntro2();
+   void _HearSounds(const QString &Path, bool Sounding);
+   void _HearHud();
+   void _HearTelemetry();
 private slots:
    void _Poll();
 protected:
@@ -68,6 +101,8 @@ public:
    void SetLevel(const double &Level);
    int GetPollRate() const;
    void SetPollRate(int PollRate);
+   int GetTurbo() const;
+   void SetTurbo(int Turbo);
    bool EnKey(int Key);
    bool DeKey(int Key);
 };
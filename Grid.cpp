@@ -0,0 +1,57 @@
+// Asteroid Style Game: The uniform grid used to find nearby objects without checking every pair.
+// Copyright (c) 2021 Darth Spectra
+#include <math.h>
+#include "Grid.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// The maximum number of cells along either axis, for a handful of items; larger grids cost more to clear than they save.
+// A crowd of items may have up to CellsPerItem cells for each of them, so that the cells stay sparse however large the crowd.
+static const int MaxCells = 64, CellsPerItem = 8;
+
+// class Grid: private methods
+// ───────────────────────────
+// The clamped column and row of a position.
+int Grid::_CellX(double X) const {
+   int Cx = (int)((X - _X0)/_Cell);
+   return Cx < 0? 0: Cx >= _Cols? _Cols - 1: Cx;
+}
+
+int Grid::_CellY(double Y) const {
+   int Cy = (int)((Y - _Y0)/_Cell);
+   return Cy < 0? 0: Cy >= _Rows? _Rows - 1: Cy;
+}
+
+// class Grid: public methods
+// ──────────────────────────
+// Make a new, empty, Grid object, with room set aside for the largest layout and Items items.
+Grid::Grid(int Items/* = 0*/) {
+   _X0 = 0.0, _Y0 = 0.0, _Cell = 1.0, _Cols = 1, _Rows = 1;
+   _Head.reserve((MaxCells + 1)*(MaxCells + 1)), _Head.assign(1, -1), _Next.reserve(Items);
+}
+
+// Empty the grid and lay it out over [X0, X1] × [Y0, Y1] with cells at least Cell wide, for items numbered in [0, Items).
+// The storage is kept between calls, so that a grid reset on every tick settles down to not allocating.
+void Grid::Reset(double X0, double Y0, double X1, double Y1, double Cell, int Items) {
+   double Xs = X1 - X0, Ys = Y1 - Y0;
+   if (Xs < 1.0) Xs = 1.0;
+   if (Ys < 1.0) Ys = 1.0;
+   double Cells = (double)CellsPerItem*Items; if (Cells < (double)MaxCells*MaxCells) Cells = (double)MaxCells*MaxCells;
+   double Span = sqrt(Cells);
+   if (Cell < Xs/Span) Cell = Xs/Span;
+   if (Cell < Ys/Span) Cell = Ys/Span;
+   _X0 = X0, _Y0 = Y0, _Cell = Cell;
+   _Cols = (int)(Xs/Cell) + 1, _Rows = (int)(Ys/Cell) + 1;
+   _Head.assign(_Cols*_Rows, -1), _Next.assign(Items, -1);
+}
+
+// Add item number Item at Pos; an item numbered past those that the grid was laid out for makes room for itself.
+void Grid::Add(int Item, const ObjPos &Pos) {
+   if (Item >= (int)_Next.size()) _Next.resize(Item + 1, -1);
+   int &Head = _Head[_CellY(Pos.imag())*_Cols + _CellX(Pos.real())];
+   _Next[Item] = Head, Head = Item;
+}
+
+// The cell size.
+double Grid::GetCell() const { return _Cell; }
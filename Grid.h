@@ -0,0 +1,61 @@
+#ifndef OnceOnlyGrid_h
+#define OnceOnlyGrid_h
+
+// Asteroid Style Game: The uniform grid used to find nearby objects without checking every pair.
+// Copyright (c) 2021 Darth Spectra
+#include <vector>
+#include "Objects.h"
+
+namespace Asteroid {
+// The broad-phase grid
+// ────────────────────
+// Items are binned by position into square cells over a fixed rectangle,
+// which is normally the play area plus its Kuypier margin.
+// Positions outside the rectangle are clamped to the border cells;
+// this never separates two items by more than it does inside the rectangle, so no neighbor is lost.
+class Grid {
+private:
+   double _X0, _Y0, _Cell;
+   int _Cols, _Rows;
+   std::vector<int> _Head, _Next;
+   int _CellX(double X) const;
+   int _CellY(double Y) const;
+public:
+   Grid(int Items = 0);
+   void Reset(double X0, double Y0, double X1, double Y1, double Cell, int Items);
+   void Add(int Item, const ObjPos &Pos);
+   double GetCell() const;
+// Call Near(Item) for each item in the cell containing Pos and in the 8 cells surrounding it.
+// If the cell size is no smaller than the largest distance of interest, then every item within that distance of Pos is visited.
+   template <typename Fn> void Near(const ObjPos &Pos, Fn Near) const {
+      int X = _CellX(Pos.real()), Y = _CellY(Pos.imag());
+      int X0 = X > 0? X - 1: 0, X1 = X < _Cols - 1? X + 1: _Cols - 1;
+      int Y0 = Y > 0? Y - 1: 0, Y1 = Y < _Rows - 1? Y + 1: _Rows - 1;
+      for (Y = Y0; Y <= Y1; Y++) for (X = X0; X <= X1; X++)
+         for (int Item = _Head[Y*_Cols + X]; Item >= 0; Item = _Next[Item]) Near(Item);
+   }
+// The item nearest to Pos, or -1 if the grid is empty, where Dist(Item) is the distance of Item from Pos; ties go to the lowest-numbered item.
+// The search goes out from Pos ring by ring of cells, and stops once the cells further out are too far away to hold anything nearer.
+   template <typename Fn> int Nearest(const ObjPos &Pos, Fn Dist) const {
+      int X = _CellX(Pos.real()), Y = _CellY(Pos.imag());
+      int Rs = X > _Cols - 1 - X? X: _Cols - 1 - X, Ry = Y > _Rows - 1 - Y? Y: _Rows - 1 - Y; if (Ry > Rs) Rs = Ry;
+      int Best = -1; double BestD = 0.0;
+      for (int R = 0; R <= Rs && (Best < 0 || BestD >= (R - 1)*_Cell); R++)
+         for (int Yr = Y - R; Yr <= Y + R; Yr++) {
+            if (Yr < 0 || Yr >= _Rows) continue;
+         // The top and bottom rows of the ring are whole; in between, only the two ends are in the ring.
+            int dX = Yr == Y - R || Yr == Y + R? 1: 2*R; if (dX == 0) dX = 1;
+            for (int Xr = X - R; Xr <= X + R; Xr += dX) {
+               if (Xr < 0 || Xr >= _Cols) continue;
+               for (int Item = _Head[Yr*_Cols + Xr]; Item >= 0; Item = _Next[Item]) {
+                  double D = Dist(Item);
+                  if (Best < 0 || D < BestD || (D == BestD && Item < Best)) Best = Item, BestD = D;
+               }
+            }
+         }
+      return Best;
+   }
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,154 @@
+// Asteroid Style Game: The bulk motion kernels, which move and wrap every object in the store at once.
+// Copyright (c) 2021 Darth Spectra
+#include <atomic>
+#include "Kernel.h"
+
+// The vector kernels are built with GCC's (and Clang's) per-function target attributes,
+// so the rest of the program needs no special compiler flags and still runs on processors without AVX2.
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#   define X86Kernels 1
+#   include <immintrin.h>
+#else
+#   define X86Kernels 0
+#endif
+
+using namespace Asteroid;
+
+typedef void (*IntegrateFn)(double *X, double *Y, const double *DX, const double *DY, size_t N);
+typedef void (*WrapFn)(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY);
+
+// The plain C++ kernels
+// ─────────────────────
+// These also finish off the few rows left over at the end by the vector kernels.
+static void IntegrateScalar(double *X, double *Y, const double *DX, const double *DY, size_t N) {
+   for (size_t n = 0; n < N; n++) X[n] += DX[n], Y[n] += DY[n];
+}
+
+static void WrapScalar(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY) {
+   for (size_t n = 0; n < N; n++) {
+      double MX = Kuyp[n]*KX, MY = Kuyp[n]*KY;
+      double X0 = -MX, X1 = Xs + MX, Y0 = -MY, Y1 = Ys + MY;
+      X[n] = X[n] < X0? X1: X[n] > X1? X0: X[n];
+      Y[n] = Y[n] < Y0? Y1: Y[n] > Y1? Y0: Y[n];
+   }
+}
+
+#if X86Kernels
+// The SSE2 kernels: 2 rows at a time.
+// ───────────────────────────────────
+__attribute__((target("sse2")))
+static void IntegrateSSE2(double *X, double *Y, const double *DX, const double *DY, size_t N) {
+   size_t n = 0;
+   for (; n + 2 <= N; n += 2)
+      _mm_storeu_pd(X + n, _mm_add_pd(_mm_loadu_pd(X + n), _mm_loadu_pd(DX + n))),
+      _mm_storeu_pd(Y + n, _mm_add_pd(_mm_loadu_pd(Y + n), _mm_loadu_pd(DY + n)));
+   IntegrateScalar(X + n, Y + n, DX + n, DY + n, N - n);
+}
+
+// Wrap one coordinate: SSE2 has no blend, so the choice is made with masks.
+__attribute__((target("sse2")))
+static inline __m128d WrapSSE2(__m128d P, __m128d Margin, __m128d Size, __m128d Sign) {
+   __m128d P0 = _mm_xor_pd(Margin, Sign), P1 = _mm_add_pd(Size, Margin);
+   __m128d Lo = _mm_cmplt_pd(P, P0), Hi = _mm_cmpgt_pd(P, P1);
+   __m128d Out = _mm_or_pd(_mm_and_pd(Lo, P1), _mm_and_pd(Hi, P0));
+   return _mm_or_pd(Out, _mm_andnot_pd(_mm_or_pd(Lo, Hi), P));
+}
+
+__attribute__((target("sse2")))
+static void WrapSSE2(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY) {
+   const __m128d XsV = _mm_set1_pd(Xs), YsV = _mm_set1_pd(Ys), KXV = _mm_set1_pd(KX), KYV = _mm_set1_pd(KY), Sign = _mm_set1_pd(-0.0);
+   size_t n = 0;
+   for (; n + 2 <= N; n += 2) {
+      __m128d K = _mm_loadu_pd(Kuyp + n);
+      _mm_storeu_pd(X + n, WrapSSE2(_mm_loadu_pd(X + n), _mm_mul_pd(K, KXV), XsV, Sign));
+      _mm_storeu_pd(Y + n, WrapSSE2(_mm_loadu_pd(Y + n), _mm_mul_pd(K, KYV), YsV, Sign));
+   }
+   WrapScalar(X + n, Y + n, Kuyp + n, N - n, Xs, Ys, KX, KY);
+}
+
+// The AVX2 kernels: 4 rows at a time.
+// ───────────────────────────────────
+__attribute__((target("avx2")))
+static void IntegrateAVX2(double *X, double *Y, const double *DX, const double *DY, size_t N) {
+   size_t n = 0;
+   for (; n + 4 <= N; n += 4)
+      _mm256_storeu_pd(X + n, _mm256_add_pd(_mm256_loadu_pd(X + n), _mm256_loadu_pd(DX + n))),
+      _mm256_storeu_pd(Y + n, _mm256_add_pd(_mm256_loadu_pd(Y + n), _mm256_loadu_pd(DY + n)));
+   IntegrateScalar(X + n, Y + n, DX + n, DY + n, N - n);
+}
+
+__attribute__((target("avx2")))
+static inline __m256d WrapAVX2(__m256d P, __m256d Margin, __m256d Size, __m256d Sign) {
+   __m256d P0 = _mm256_xor_pd(Margin, Sign), P1 = _mm256_add_pd(Size, Margin);
+   P = _mm256_blendv_pd(P, P1, _mm256_cmp_pd(P, P0, _CMP_LT_OQ));
+   return _mm256_blendv_pd(P, P0, _mm256_cmp_pd(P, P1, _CMP_GT_OQ));
+}
+
+__attribute__((target("avx2")))
+static void WrapAVX2(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY) {
+   const __m256d XsV = _mm256_set1_pd(Xs), YsV = _mm256_set1_pd(Ys), KXV = _mm256_set1_pd(KX), KYV = _mm256_set1_pd(KY);
+   const __m256d Sign = _mm256_set1_pd(-0.0);
+   size_t n = 0;
+   for (; n + 4 <= N; n += 4) {
+      __m256d K = _mm256_loadu_pd(Kuyp + n);
+      _mm256_storeu_pd(X + n, WrapAVX2(_mm256_loadu_pd(X + n), _mm256_mul_pd(K, KXV), XsV, Sign));
+      _mm256_storeu_pd(Y + n, WrapAVX2(_mm256_loadu_pd(Y + n), _mm256_mul_pd(K, KYV), YsV, Sign));
+   }
+   WrapScalar(X + n, Y + n, Kuyp + n, N - n, Xs, Ys, KX, KY);
+}
+#endif
+
+// The kernel table
+// ────────────────
+static const struct { const char *Name; IntegrateFn Integrate; WrapFn Wrap; } Kernels[KernelN] = {
+   { "scalar", IntegrateScalar, WrapScalar },
+#if X86Kernels
+   { "sse2", IntegrateSSE2, WrapSSE2 },
+   { "avx2", IntegrateAVX2, WrapAVX2 }
+#else
+   { "sse2", nullptr, nullptr },
+   { "avx2", nullptr, nullptr }
+#endif
+};
+
+// The kernel in use, or KernelN if it is not yet chosen.
+// It is read by every engine, on whichever thread runs it, so it is atomic; relaxed loads and stores are enough, since it selects code, not data,
+// and any thread that chooses it lazily chooses the same one.
+static std::atomic<KernelT> CurKernel(KernelN);
+
+bool Asteroid::HasKernel(KernelT K) {
+   switch (K) {
+      case ScalarK: return true;
+#if X86Kernels
+      case SSE2K: return __builtin_cpu_supports("sse2");
+      case AVX2K: return __builtin_cpu_supports("avx2");
+#endif
+      default: return false;
+   }
+}
+
+KernelT Asteroid::BestKernel() {
+   return HasKernel(AVX2K)? AVX2K: HasKernel(SSE2K)? SSE2K: ScalarK;
+}
+
+KernelT Asteroid::GetKernel() {
+   KernelT K = CurKernel.load(std::memory_order_relaxed);
+   if (K == KernelN) K = BestKernel(), CurKernel.store(K, std::memory_order_relaxed);
+   return K;
+}
+
+// Use kernel K from now on, if the processor supports it.
+bool Asteroid::SetKernel(KernelT K) {
+   if (!HasKernel(K)) return false;
+   CurKernel.store(K, std::memory_order_relaxed); return true;
+}
+
+const char *Asteroid::KernelName(KernelT K) { return K >= ScalarK && K < KernelN? Kernels[K].Name: "none"; }
+
+void Asteroid::Integrate(double *X, double *Y, const double *DX, const double *DY, size_t N) {
+   Kernels[GetKernel()].Integrate(X, Y, DX, DY, N);
+}
+
+void Asteroid::Wrap(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY) {
+   Kernels[GetKernel()].Wrap(X, Y, Kuyp, N, Xs, Ys, KX, KY);
+}
@@ -0,0 +1,30 @@
+#ifndef OnceOnlyKernel_h
+#define OnceOnlyKernel_h
+
+// Asteroid Style Game: The bulk motion kernels, which move and wrap every object in the store at once.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+
+namespace Asteroid {
+// The motion kernels
+// ──────────────────
+// Integrate() adds the velocity columns into the position columns.
+// Wrap() moves the objects that have strayed past the edge of the play area over to the other side.
+// The margin past the edge is given per object by the mask Kuyp, which is 1 for objects that roam the Kuypier region and 0 for those held to the screen:
+// an object in row n may stray as far as Kuyp[n]*KX to the left or right of [0, Xs], and Kuyp[n]*KY above or below [0, Ys].
+// Both run without branches, in SSE2 or AVX2 when the processor has them, or else in plain C++;
+// the results are the same, to the bit, whichever is used.
+enum KernelT { ScalarK, SSE2K, AVX2K, KernelN };
+
+// The fastest kernel that the processor supports; this is the one used, unless SetKernel() picks another.
+KernelT BestKernel();
+KernelT GetKernel();
+bool HasKernel(KernelT K);
+bool SetKernel(KernelT K);
+const char *KernelName(KernelT K);
+
+void Integrate(double *X, double *Y, const double *DX, const double *DY, size_t N);
+void Wrap(double *X, double *Y, const double *Kuyp, size_t N, double Xs, double Ys, double KX, double KY);
+} // end of namespace Asteroid
+
+#endif // OnceOnly
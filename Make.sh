@@ -1 +1,4 @@
+/usr/lib64/qt4/bin/qmake -makefile -o Makefile.Engine Engine.pro
+/usr/lib64/qt4/bin/qmake -makefile -o Makefile.Simulate Simulate.pro
+/usr/lib64/qt4/bin/qmake -makefile -o Makefile.Bench Bench.pro
 /usr/lib64/qt4/bin/qmake -makefile Asteroid.pro
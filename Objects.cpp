@@ -1,10 +1,11 @@
 // Asteroid Style Game: The objects to hold the state of the game artifacts.
 // Copyright (c) 2009 Big Angry Dog, (c) 2016-2018 Darth Ninja, (c) 2021 Darth Spectra
 #include <math.h>
-#include <stdlib.h>
-#include <time.h>
+#include <string.h>
 #include "Objects.h"
 #include "Engine.h"
+#include "Shapes.h"
+#include "Store.h"
 
 using namespace std;
 using namespace Asteroid;
@@ -17,96 +18,121 @@ static const double TwoPi = 6.28318530717958648;
 
 // class Thing: protected methods
 // ──────────────────────────────
-// The (mean) radius of this object.
-double Thing::_SizeUp() const {
-   double R = 0.0;
-   for (int n = 0; n < _Points; n++) R += abs(_Point[n])/_Points;
-   return R;
-}
+// The age of this object, in whole seconds of the engine clock.
+int Thing::_Age() const { return (_Owner->GetTicks() - _Now)/TickRate; }
+
+// Set the collision radius.
+void Thing::_SetRadius(double Radius) { _Store->Radius[_Row] = Radius; }
+
+// Set the shape, and with it, the collision radius.
+void Thing::_SetShape(ShapeT Shape) { _Shape = Shape, _SetRadius(ShapeOf(Shape).Radius); }
 
 // Add N copies of type T to the list, with the given SpeedUp.
 void Thing::_Replicate(TypeT T, int N, const double &SpeedUp/* = 1.0*/) {
    if (N > 0) {
    // Space away the main from the origin moving them in oposite directions.
-      ObjPos NDir(_Dir), NPos(_Dir), BDir(_Dir/2.0);
-      Thing::RotateVector(NDir, TwoPi/4.0);
+      ObjPos Pos(GetPos()), Dir(GetDir());
+      ObjPos NDir(Dir), NPos(Dir), BDir(Dir/2.0);
+   // A quarter turn, then N equal turns of Phi around the full circle.
+      const ObjPos Quarter(0.0, 1.0); double Phi = TwoPi/N; ObjPos Turn(cos(Phi), sin(Phi));
+      NDir = Thing::Turned(NDir, Quarter);
       if (NDir != 0.0) NDir *= SpeedUp/abs(NDir);
-      if (NPos != 0.0) NPos *= _Radius/abs(NPos), Thing::RotateVector(NPos, TwoPi/4.0);
-      double Phi = TwoPi/N;
-      for (int n = 0; n < N; n++)
-         _Owner->AddThing(T, _Pos + NPos, BDir + NDir), Thing::RotateVector(NDir, Phi), Thing::RotateVector(NPos, Phi);
+      if (NPos != 0.0) NPos *= GetRadius()/abs(NPos), NPos = Thing::Turned(NPos, Quarter);
+      for (int n = 0; n < N; n++) {
+         if (Particulate(T)) _Owner->AddParticle(T, Pos + NPos, BDir + NDir); else _Owner->AddThing(T, Pos + NPos, BDir + NDir);
+         NDir = Thing::Turned(NDir, Turn), NPos = Thing::Turned(NPos, Turn);
+      }
    }
 }
 
-// The Tick()-handler, for default motion and updates.
+// The Tick()-handler, for default updates.
+// The engine moves all the objects at once, before ticking them, so this need only turn the object, which only changes its angle.
 void Thing::_Tick() {
-   if (!_Dead) {
+   if (!GetDead()) {
    // Increment the internal tick counter.
    // Check the range just in case the game was left running for several years.
       if (++_Ticks >= 0x7fffffff) _Ticks = 1000;
-   // Move and rotate the object.
-      _Pos += _Dir, Rotate(_Twist);
+   // Rotate the object.
+      Rotate(_Twist);
    }
 }
 
 // class Thing: public methods
 // ───────────────────────────
 // Make a new Thing object; the base constructor is to be called by derived classes in their constructors.
+// This takes a new row in the owner's store, at rest at the origin.
 Thing::Thing(Engine &Owner) {
-   _Point = nullptr, _Points = 0, _Dead = false, _Radius = 0.0, _Twist = 0.0, _Ticks = 0, _Owner = &Owner, _Pts = SmallLF;
+   _Shape = NoSH, _Caption[0] = '\0', _Twist = 0.0, _Ticks = 0, _Owner = &Owner, _Pts = SmallLF;
+   _Angle = 0.0, _TurnAngle = 0.0, _Turn = ObjPos(1.0, 0.0);
+   _Store = &Owner._Store, _Row = _Store->Add(this);
 // The creation time.
-   _Now = time(0);
+   _Now = Owner.GetTicks();
 }
 
 // Free the Thing object.
-Thing::~Thing() {
-   try {
-      delete[] _Point;
-   } catch(...) { }
-}
+// This has nothing to release, which is what allows the engine to drop all its objects at once without destroying them.
+Thing::~Thing() { }
 
 // Get/set the dead state.
-bool Thing::GetDead() const { return _Dead; }
-void Thing::SetDead(bool Dead/* = true*/) { _Dead = Dead; }
+bool Thing::GetDead() const { return _Store->Dead[_Row] != 0; }
+void Thing::SetDead(bool Dead/* = true*/) { _Store->Dead[_Row] = Dead; }
 
 // Get the owner.
 Engine *Thing::GetOwner() const { return _Owner; }
 
+// Get the handle, which the owner issued when it added this object.
+Handle Thing::GetHandle() const { return _Id; }
+
+// Get/set the position and orientation vectors.
+ObjPos Thing::GetPos() const { return ObjPos(_Store->X[_Row], _Store->Y[_Row]); }
+void Thing::SetPos(const ObjPos &Pos) { _Store->X[_Row] = Pos.real(), _Store->Y[_Row] = Pos.imag(); }
+ObjPos Thing::GetDir() const { return ObjPos(_Store->DX[_Row], _Store->DY[_Row]); }
+void Thing::SetDir(const ObjPos &Dir) { _Store->DX[_Row] = Dir.real(), _Store->DY[_Row] = Dir.imag(); }
+
 // Get the radius.
-double Thing::GetRadius() const { return _Radius; }
+double Thing::GetRadius() const { return _Store->Radius[_Row]; }
 
 // Rotate the object by Rad radians.
+// The angle is kept within a full turn, so that it loses no precision however long the object spins.
 void Thing::Rotate(const double &Rad) {
-   if (Rad != 0.0) for (int n = 0; n < _Points; n++) Thing::RotateVector(_Point[n], Rad);
+   if (Rad != 0.0) _Angle = fmod(_Angle + Rad, TwoPi);
 }
 
-// The point count in the rendering.
-int Thing::GetPoints() const { return _Points; }
+// Get/set the angle by which the model points are turned; the turn, (cos Rad, sin Rad), may be given, if it is already known.
+double Thing::GetAngle() const { return _Angle; }
+void Thing::SetAngle(double Rad) { _Angle = fmod(Rad, TwoPi); }
+void Thing::SetAngle(double Rad, const ObjPos &Turn) { _Angle = Rad, _TurnAngle = Rad, _Turn = Turn; }
+
+// The shape, and its point count in the rendering.
+ShapeT Thing::GetShape() const { return _Shape; }
+int Thing::GetPoints() const { return ShapeOf(_Shape).Points; }
 
 // The point score: always relative to the current position; Points ∈ [0, GetPoints()).
-ObjPos Thing::PosPoints(int Points) const { return !_Dead && Points < _Points? _Point[Points] + _Pos: ObjPos(); }
+// The turn is only worked out again when the angle has changed since it was last asked for, which is at most once a tick.
+ObjPos Thing::PosPoints(int Points) const {
+   const Shape &S = ShapeOf(_Shape);
+   if (GetDead() || Points >= S.Points) return ObjPos();
+   if (_TurnAngle != _Angle) _TurnAngle = _Angle, _Turn = ObjPos(cos(_Angle), sin(_Angle));
+   return Thing::Turned(S.Point[Points], _Turn) + GetPos();
+}
 
-// Get/set the caption.
-std::string Thing::GetCaption() const { return _Caption; }
-void Thing::SetCaption(const std::string &Caption) { _Caption = Caption; }
+// Get/set the caption; it is cut short to fit, if need be.
+const char *Thing::GetCaption() const { return _Caption; }
+void Thing::SetCaption(const char *Caption) { strncpy(_Caption, Caption, MaxCaption - 1), _Caption[MaxCaption - 1] = '\0'; }
 
 // Get/set the font size.
 FontT Thing::GetPts() const { return _Pts; }
 void Thing::SetPts(FontT Pts) { _Pts = Pts; }
 
-// A uniformly-distributed random number over [0, 1).
-double Thing::RandR() { return (double)rand()/RAND_MAX; }
+// A uniformly-distributed random number over [0, 1), from the owner's generator.
+double Thing::RandR() const { return _Owner->GetRandom().RandR(); }
 
-// A random boolean value with probability Prob for ‟true”.
-bool Thing::RandB(double Prob/* = 0.5*/) { return rand() < RAND_MAX*Prob; }
+// A random boolean value with probability Prob for ‟true”, from the owner's generator.
+bool Thing::RandB(double Prob/* = 0.5*/) const { return _Owner->GetRandom().RandB(Prob); }
 
 // Rotate the vector Pos around the origin by Rad radians, where Rad > 0 means counter-clockwise and Rad < 0 means clockwize.
 void Thing::RotateVector(ObjPos &Pos, double Rad) {
-   if (Pos != 0.0) {
-      Rad += arg(Pos);
-      double PosA = abs(Pos);
-      Pos = ObjPos(PosA*cos(Rad), PosA*sin(Rad));
-   }
+   if (Pos != 0.0) Pos = Thing::Turned(Pos, ObjPos(cos(Rad), sin(Rad)));
 }
 
 // Limit the absolute value.
@@ -117,22 +143,13 @@ void Thing::LimitAbs(ObjPos &Pos, const double A) {
 
 // class Rock: protected methods
 // ─────────────────────────────
-// Create rock points.
-// This is a circle with random variation made to the points, sized up/down by Scale.
-void Rock::_Sculpt(const double &Scale) {
-   _Points = 21, _Point = new ObjPos[_Points];
-   const double Vf = 0.25;
-   double Alpha = 0.0;
-// Rumple it.
-   for (int n = 0; n < _Points - 1; n++)
-      _Point[n] = ObjPos(20.0*sin(Alpha), 20.0*cos(Alpha)),
-      Alpha += TwoPi/(_Points - 1),
-      _Point[n] *= Scale,
-      _Point[n] += ObjPos(Vf*_Point[n].real()*(2.0*Thing::RandR() - 1.0), Vf*_Point[n].imag()*(2.0*Thing::RandR() - 1.0));
-// Connect the final point.
-   _Point[_Points - 1] = _Point[0];
-// Get the collision radius.
-   _Radius = _SizeUp();
+// Pick a rock from the shape library's bank of variants, starting at Bank, with a rotation speed of Twist radians per tick in a random direction.
+// The rocks in each bank are circles with random variation made to the points, sized up/down for the rock's class.
+void Rock::_Sculpt(ShapeT Bank, const double &Twist) {
+// Draw all the random values at once: the rotation direction, the variant and the orientation.
+   double R[3]; _Owner->GetRandom().Fill(R, 3);
+   _Twist = R[0] < 0.5? -Twist: Twist;
+   _SetShape((ShapeT)(Bank + (int)(R[1]*RockVariants))), Rotate(TwoPi*R[2]);
 }
 
 // class Rock: public methods
@@ -141,10 +158,10 @@ void Rock::_Sculpt(const double &Scale) {
 Rock::Rock(Engine &Owner): Thing(Owner) { }
 
 // Is it a rock?
-bool Rock::Rocky() const { return true; }
+bool Rock::Rocky() const { return TypeRocky; }
 
 // Can it occupy the Kuypier region?
-bool Rock::Kuypier() const { return true; }
+bool Rock::Kuypier() const { return TypeKuypier; }
 
 // Would a collision with Other be fatal?
 // Collisions in the Kuypier region are never fatal,
@@ -153,18 +170,19 @@ bool Rock::Kuypier() const { return true; }
 bool Rock::Lethal(const Thing &Other) const {
    if (Other.GetDead()) return false;
    int Xs, Ys; _Owner->GetPlayDims(&Xs, &Ys);
+   ObjPos Pos(GetPos());
    return
       Other.Type() == LanceOT && _Ticks > 2? true:
-      _Pos.real() >= 0 && _Pos.real() <= Xs && _Pos.imag() >= 0 && _Pos.imag() <= Ys &&
-      abs(_Dir - Other._Dir) > MaxShipSpeed/5.0 && (Other.Mass() > Mass() || (Other.Mass() == Mass() && Thing::RandB()));
+      Pos.real() >= 0 && Pos.real() <= Xs && Pos.imag() >= 0 && Pos.imag() <= Ys &&
+      abs(GetDir() - Other.GetDir()) > MaxShipSpeed/5.0 && (Other.Mass() > Mass() || (Other.Mass() == Mass() && RandB()));
 }
 
 // Move and rotate, with a random end of life after a preset time period.
 void Rock::Tick() {
-   if (!_Dead) {
+   if (!GetDead()) {
       _Tick();
    // Random end of life after a preset time period.
-      if (Type() != PebbleOT && time(0) - _Now > RockLifeTicks && Thing::RandB(RockBreakProb)) Boom();
+      if (Type() != PebbleOT && _Age() > RockLifeTicks && RandB(RockBreakProb)) Boom();
    }
 }
 
@@ -172,125 +190,118 @@ void Rock::Tick() {
 // ─────────────────────────────
 // Make a new Boulder object; endowed with a rotation speed of approximately 1 degree per tick.
 Boulder::Boulder(Engine &Owner): Rock(Owner) {
-   _Twist = TwoPi*1.0/360.0; if (Thing::RandB()) _Twist = -_Twist;
-// Create the points.
-   _Sculpt(1.0);
+// Set the shape.
+   _Sculpt(BoulderSH, TwoPi*1.0/360.0);
 }
 
 // The object's score, type, mass and termination routine.
 int Boulder::Score() const { return 100; }
 TypeT Boulder::Type() const { return BoulderOT; }
-double Boulder::Mass() const { return 300; }
-void Boulder::Boom() { _Dead = true, _Replicate(StoneOT, 2), _Replicate(SparkOT, 5, 4.0); }
+double Boulder::Mass() const { return TypeMass; }
+void Boulder::Boom() { SetDead(), _Replicate(StoneOT, 2), _Replicate(SparkOT, 5, 4.0); }
 
 // class Stone: public methods
 // ───────────────────────────
 // Make a new Stone object; endowed with a rotation speed of approximately 2 degrees per tick.
 Stone::Stone(Engine &Owner): Rock(Owner) {
-   _Twist = TwoPi*2.0/360.0; if (Thing::RandB()) _Twist = -_Twist;
-// Create the points.
-   _Sculpt(0.71);
+// Set the shape.
+   _Sculpt(StoneSH, TwoPi*2.0/360.0);
 }
 
 // The object's score, type, mass and termination routine.
 int Stone::Score() const { return 50; }
 TypeT Stone::Type() const { return StoneOT; }
-double Stone::Mass() const { return 200; }
-void Stone::Boom() { _Dead = true, _Replicate(PebbleOT, 2), _Replicate(SparkOT, 3, 2.0); }
+double Stone::Mass() const { return TypeMass; }
+void Stone::Boom() { SetDead(), _Replicate(PebbleOT, 2), _Replicate(SparkOT, 3, 2.0); }
 
 // class Pebble: public methods
 // ────────────────────────────
 // Make a new Pebble object; endowed with a rotation speed of approximately 4 degrees per tick.
 Pebble::Pebble(Engine &Owner): Rock(Owner) {
-   _Twist = TwoPi*4.0/360.0; if (Thing::RandB()) _Twist = -_Twist;
-// Create the points.
-   _Sculpt(0.4);
+// Set the shape.
+   _Sculpt(PebbleSH, TwoPi*4.0/360.0);
 }
 
 // The object's score, type, mass and termination routine.
 int Pebble::Score() const { return 25; }
 TypeT Pebble::Type() const { return PebbleOT; }
-double Pebble::Mass() const { return 125; }
-void Pebble::Boom() { _Dead = true, _Replicate(DebrisOT, 5); }
+double Pebble::Mass() const { return TypeMass; }
+void Pebble::Boom() { SetDead(), _Replicate(DebrisOT, 5); }
+
+// Gun and thrust postions, in the ship's model.
+static const ObjPos ShipNose(0.0, -14.0); // Forward facing tip.
+static const ObjPos ShipThrustPos(3.0, 10.0); // A bottom corner.
+static const ObjPos ShipThrustPlane(-6.0, 0.0); // The line from one bottom point to the other.
+
+// The turn, (cos, sin), for each of the ship's orientations; these are worked out once, rather than on every spin.
+static const ObjPos &ShipTurn(int Orient) {
+   static const struct TurnTable {
+      ObjPos Turn[ShipTurns];
+      TurnTable() { for (int n = 0; n < ShipTurns; n++) Turn[n] = ObjPos(cos(n*TwoPi/ShipTurns), sin(n*TwoPi/ShipTurns)); }
+   } Table;
+   return Table.Turn[Orient];
+}
 
 // class Ship: private methods
 // ───────────────────────────
-// Reset the points; used in rotation to avoid a build-up of rounding errors.
-void Ship::_ResetPoints() {
-// Must be _Points number of points.
-   _Point[0] = ObjPos(0.0, -10.0), _Point[1] = ObjPos(7.0, 10.0);
-   _Point[2] = ObjPos(0.0, 7.0), _Point[3] = ObjPos(-7.0, 10.0), _Point[4] = ObjPos(0.0, -10.0);
-// Gun and thrust postions.
-   _NosePos = ObjPos(0.0, -14.0); // Forward facing tip.
-   _ThrustPos = ObjPos(3.0, 10.0); // A bottom corner.
-   _ThrustPlane = ObjPos(-6.0, 0.0); // The line from one bottom point to the other.
-}
+// Set the orientation, in steps of ShipRotateRate degrees.
+void Ship::_SetOrient(int Orient) { _Orient = Orient, SetAngle(Orient*TwoPi/ShipTurns, ShipTurn(Orient)); }
 
 // class Ship: public methods
 // ──────────────────────────
 // Make a new Ship object.
 Ship::Ship(Engine &Owner): Thing(Owner) {
    _Firing = false, _FireLock = false, _JustFired = false, _FireCharge = MaxCharge;
-   _Spin = 0, _Pushing = false, _Orient = TwoPi/8.0;
-// Create the points.
-   _Points = 5, _Point = new ObjPos[_Points];
-// The points are set here.
-   _ResetPoints(), Rotate(_Orient);
-   Thing::RotateVector(_NosePos, _Orient);
-   Thing::RotateVector(_ThrustPos, _Orient);
-   Thing::RotateVector(_ThrustPlane, _Orient);
-// Get the collision radius.
-   _Radius = _SizeUp();
+   _Spin = 0, _Pushing = false;
+// Set the shape.
+   _SetShape(ShipSH);
+// Start off at 45 degrees.
+   _SetOrient(ShipTurns/8);
 }
 
 // Is it a rock?
-bool Ship::Rocky() const { return false; }
+bool Ship::Rocky() const { return TypeRocky; }
 
 // Can it occupy the Kuypier region?
-bool Ship::Kuypier() const { return false; }
+bool Ship::Kuypier() const { return TypeKuypier; }
 
 // Would a collision with Other be fatal?
 bool Ship::Lethal(const Thing &Other) const { return !Other.GetDead() && Other.Mass() > Mass(); }
 
 // Move the object, recharge, rotate, thrust and fire.
 void Ship::Tick() {
-   if (!_Dead) {
+   if (!GetDead()) {
       _Tick();
    // Increment the fire charge.
       if (_FireCharge < MaxCharge && _Ticks%ReChargeTicks == 0) _FireCharge++;
-   // Spin.
-      if (_Spin != 0) {
-         if (_Spin == -1) _Orient -= ShipRotateRate*TwoPi/360.0; else _Orient += ShipRotateRate*TwoPi/360.0;
-      // Rotate the superstructure, then the nose and thrust plane assemblies.
-         _ResetPoints(), Rotate(_Orient);
-         Thing::RotateVector(_NosePos, _Orient);
-         Thing::RotateVector(_ThrustPos, _Orient);
-         Thing::RotateVector(_ThrustPlane, _Orient);
-      }
+   // Spin, by one step.
+      if (_Spin != 0) _SetOrient((_Orient + (_Spin == -1? ShipTurns - 1: 1))%ShipTurns);
+      const ObjPos &Turn = ShipTurn(_Orient);
    // Push.
       if (_Pushing) {
       // Thrust vector.
-         ObjPos Thrust(sin(_Orient), -cos(_Orient)); Thrust *= ShipPushMult;
+         ObjPos Thrust(Turn.imag(), -Turn.real()); Thrust *= ShipPushMult;
       // Exhaust vector.
-         ObjPos Expel(Thrust*(-MaxShipSpeed/2.0) + _Dir);
+         ObjPos Expel(Thrust*(-MaxShipSpeed/2.0) + GetDir());
       // Add thrust particles.
          for (int n = 0; n < 2; n++) {
          // Random exhaust exit position.
-            ObjPos Smoke(_ThrustPlane*Thing::RandR()); Smoke += _ThrustPos + _Pos;
-            Thing *Obj = _Owner->AddThing(ThrustOT, Smoke, Expel); Obj->Rotate(_Orient);
+            ObjPos Smoke(Thing::Turned(ShipThrustPlane, Turn)*RandR()); Smoke += Thing::Turned(ShipThrustPos, Turn) + GetPos();
+            _Owner->AddParticle(ThrustOT, Smoke, Expel, GetAngle());
          }
       // Add thrust to the direction, and limit to the maximum speed, so as to avoid catching up with friendly fire.
-         _Dir += Thrust, Thing::LimitAbs(_Dir, MaxShipSpeed);
+         ObjPos Dir(GetDir() + Thrust); Thing::LimitAbs(Dir, MaxShipSpeed), SetDir(Dir);
       }
    // Fire (suppress, if not charged).
       if (!_Firing || _FireLock || _FireCharge <= 0) _Firing = false, _JustFired = false;
       else {
       // Create a fire object (initially heading toward the ship).
-         ObjPos Fire(sin(_Orient), -cos(_Orient)); Fire *= MaxShipSpeed, Fire += _Dir;
+         ObjPos Fire(Turn.imag(), -Turn.real()); Fire *= MaxShipSpeed, Fire += GetDir();
       // Recoil.
-         _Dir -= Fire*FireRecoilMult;
+         SetDir(GetDir() - Fire*FireRecoilMult);
       // Bombs away!
-         Thing *Obj = _Owner->AddThing(LanceOT, _NosePos + _Pos, Fire); Obj->Rotate(_Orient);
+         Thing *Obj = _Owner->AddThing(LanceOT, Thing::Turned(ShipNose, Turn) + GetPos(), Fire); Obj->SetAngle(GetAngle(), Turn);
+         _Owner->Emit(LanceEV, LanceOT, Obj->GetPos());
       // Suppress repeated firing.
          _FireLock = true, _JustFired = true, _FireCharge--;
       }
@@ -300,8 +311,8 @@ void Ship::Tick() {
 // The object's score, type, mass and termination routine.
 int Ship::Score() const { return 0; }
 TypeT Ship::Type() const { return ShipOT; }
-double Ship::Mass() const { return 10; }
-void Ship::Boom() { _Dead = true, _Replicate(DebrisOT, 5); }
+double Ship::Mass() const { return TypeMass; }
+void Ship::Boom() { SetDead(), _Replicate(DebrisOT, 5); }
 
 // Set the rotate state on the next tick: Spin == -1: left, Spin == +1: right, Spin == 0: stop.
 void Ship::SetSpin(int Spin) { _Spin = Spin; }
@@ -331,22 +342,15 @@ int Ship::FireCharge() const { return _FireCharge; }
 // class Alien: private methods
 // ────────────────────────────
 // The nearest fatal object to the alien or nullptr, if there are no objects.
-Thing *Alien::_Neighbor() const {
-   Thing *NearO = nullptr; double NearD = -1.0;
-// Find the nearest heavier object or ship (avoid the ship).
-   for (size_t n = 0; n < _Owner->ObjN(); n++) {
-      Thing *Obj = _Owner->ObjAtN(n); double D = abs(_Pos - Obj->_Pos);
-      if ((Obj->Mass() > Mass() || Obj->Type() == ShipOT) && (NearD < 0.0 || D < NearD)) NearO = Obj, NearD = D;
-   }
-   return NearO;
-}
+// This is the nearest heavier object or ship (avoid the ship), which the owner finds in the threat index that it shares among all the aliens.
+Thing *Alien::_Neighbor() const { return _Owner->NearestThreat(GetPos()); }
 
 // Aim the thrust away from the nearest object.
 ObjPos Alien::Push() const {
-   ObjPos Pos; Thing *Obj = _Neighbor(); if (Obj != nullptr) Pos = _Pos - Obj->_Pos;
+   ObjPos Pos; Thing *Obj = _Neighbor(); if (Obj != nullptr) Pos = GetPos() - Obj->GetPos();
 // Thrust more, if there's anything nearby.
    double D = abs(Pos);
-   if (D > 0.0) Pos *= 20.0*_Radius/(D*D);
+   if (D > 0.0) Pos *= 20.0*GetRadius()/(D*D);
    return AlienPushMult*Pos;
 }
 
@@ -354,43 +358,32 @@ ObjPos Alien::Push() const {
 // ───────────────────────────
 // Make a new Alien object.
 Alien::Alien(Engine &Owner): Thing(Owner) {
-// Create the points.
-   _Points = 20, _Point = new ObjPos[_Points];
-   _Point[0] = ObjPos(5.0, -5.0), _Point[1] = ObjPos(10.0, -2.0);
-   _Point[2] = ObjPos(10.0, 2.0), _Point[3] = ObjPos(8.0, 4.0);
-   _Point[4] = ObjPos(-2.0, 4.0), _Point[5] = ObjPos(-2.0, 2.0);
-   _Point[6] = ObjPos(2.0, 2.0), _Point[7] = ObjPos(2.0, 4.0);
-   _Point[8] = ObjPos(-8.0, 4.0), _Point[9] = ObjPos(-10.0, 2.0);
-   _Point[10] = ObjPos(-10.0, -2.0), _Point[11] = ObjPos(10.0, -2.0);
-   _Point[12] = ObjPos(10.0, 2.0), _Point[13] = ObjPos(-10.0, 2.0);
-   _Point[14] = ObjPos(-10.0, -2.0), _Point[15] = ObjPos(-5.0, -5.0);
-   _Point[16] = ObjPos(0.0, -5.0), _Point[17] = ObjPos(-7.0, -2.0);
-   _Point[18] = ObjPos(-5.0, -5.0), _Point[19] = ObjPos(5.0, -5.0);
-// Get the collision radius.
-   _Radius = _SizeUp();
+// Set the shape.
+   _SetShape(AlienSH);
 }
 
 // Is it a rock?
-bool Alien::Rocky() const { return false; }
+bool Alien::Rocky() const { return TypeRocky; }
 
 // Can it occupy the Kuypier region?
-bool Alien::Kuypier() const { return true; }
+bool Alien::Kuypier() const { return TypeKuypier; }
 
 // Would a collision with Other be fatal?
 bool Alien::Lethal(const Thing &Other) const {
    if (Other.GetDead()) return false;
    int Xs, Ys; _Owner->GetPlayDims(&Xs, &Ys);
+   ObjPos Pos(GetPos());
    return
-      _Pos.real() >= 0 && _Pos.real() <= Xs && _Pos.imag() >= 0 && _Pos.imag() <= Ys &&
+      Pos.real() >= 0 && Pos.real() <= Xs && Pos.imag() >= 0 && Pos.imag() <= Ys &&
       (Other.Type() == LanceOT || Other.Mass() > Mass());
 }
 
 // Move the object.
 void Alien::Tick() {
-   if (!_Dead) {
+   if (!GetDead()) {
       _Tick();
    // Adjust the thrust.
-      _Dir += Push(), Thing::LimitAbs(_Dir, MaxAlienSpeed);
+      ObjPos Dir(GetDir() + Push()); Thing::LimitAbs(Dir, MaxAlienSpeed), SetDir(Dir);
    }
 }
 
@@ -398,36 +391,33 @@ void Alien::Tick() {
 // A big score or an extra life, for the alien.
 int Alien::Score() const { return 500; }
 TypeT Alien::Type() const { return AlienOT; }
-double Alien::Mass() const { return 15; }
-void Alien::Boom() { _Dead = true, _Replicate(DebrisOT, 5); }
+double Alien::Mass() const { return TypeMass; }
+void Alien::Boom() { SetDead(), _Replicate(DebrisOT, 5); }
 
 // class Lance: public methods
 // ───────────────────────────
 // Make a new Lance object.
 Lance::Lance(Engine &Owner): Thing(Owner) {
-// Create the points.
-   _Points = 2, _Point = new ObjPos[_Points];
-   _Point[0] = ObjPos(0.0, -2.0), _Point[1] = ObjPos(0.0, 2.0);
-// Get the collision radius.
-   _Radius = _SizeUp();
+// Set the shape.
+   _SetShape(LanceSH);
 }
 
 // Is it a rock?
-bool Lance::Rocky() const { return false; }
+bool Lance::Rocky() const { return TypeRocky; }
 
 // Can it occupy the Kuypier region?
-bool Lance::Kuypier() const { return false; }
+bool Lance::Kuypier() const { return TypeKuypier; }
 
 // Would a collision with Other be fatal?
 bool Lance::Lethal(const Thing &Other) const { return !Other.GetDead() && Other.Mass() > 0; }
 
 // Move the object.
 void Lance::Tick() {
-   if (!_Dead) {
+   if (!GetDead()) {
       _Tick();
    // Allow for it to get as much as 3/4 of the way across the screen.
-      double Speed = abs(_Dir);
-      _Dead = Speed == 0.0 || Speed*_Ticks > 3.0/4.0*_Owner->MinDim();
+      double Speed = abs(GetDir());
+      SetDead(Speed == 0.0 || Speed*_Ticks > 3.0/4.0*_Owner->MinDim());
    }
 }
 
@@ -435,101 +425,8 @@ void Lance::Tick() {
 // (No explosion on termination: just die.)
 int Lance::Score() const { return 0; }
 TypeT Lance::Type() const { return LanceOT; }
-double Lance::Mass() const { return 1; }
-void Lance::Boom() { _Dead = true; }
-
-// class Debris: public methods
-// ────────────────────────────
-// Make a new Debris object.
-Debris::Debris(Engine &Owner): Thing(Owner) {
-// Create the points.
-   _Points = 4, _Point = new ObjPos[_Points];
-   _Point[0] = ObjPos(0.0, 3.0), _Point[1] = ObjPos(3.0, 0.0), _Point[2] = ObjPos(-2.0, -3.0);
-// Rumple it.
-   const double Vf = 0.2;
-   for (int n = 0; n < _Points - 1; n++)
-      _Point[n] += ObjPos(Vf*_Point[n].real()*(2.0*Thing::RandR() - 1.0), Vf*_Point[n].imag()*(2.0*Thing::RandR() - 1.0));
-// Connect the final point and randomly orient it.
-   _Point[_Points - 1] = _Point[0], Rotate(TwoPi*Thing::RandR());
-// Endow it with a rotation speed of approximately 8 degrees per tick.
-   _Twist = TwoPi*8.0/360.0; if (Thing::RandB()) _Twist = -_Twist;
-// Get the collision radius.
-   _Radius = _SizeUp();
-}
-
-// Is it a rock?
-bool Debris::Rocky() const { return false; }
-
-// Can it occupy the Kuypier region?
-bool Debris::Kuypier() const { return true; }
-
-// Would a collision with Other be fatal?
-bool Debris::Lethal(const Thing &Other) const { return !Other.GetDead() && Other.Type() == LanceOT; }
-
-// Move the object for a short randomly-determined lifetime.
-void Debris::Tick() {
-   if (!_Dead) {
-      _Tick();
-      if (time(0) - _Now > 2 && Thing::RandB(0.1)) Boom();
-   }
-}
-
-// The object's score, type, mass and termination routine.
-// Mass 2 is just enough to bounce a ship.
-// (No explosion on termination: just die.)
-int Debris::Score() const { return 0; }
-TypeT Debris::Type() const { return DebrisOT; }
-double Debris::Mass() const { return 2; }
-void Debris::Boom() { _Dead = true; }
-
-// class Spark: public methods
-// ───────────────────────────
-// Make a new Spark object: Debris with a much shorter life.
-Spark::Spark(Engine &Owner): Debris(Owner) { }
-
-// Move the object for a very short randomly-determined lifetime.
-void Spark::Tick() {
-   if (!_Dead) {
-      _Tick();
-      double R = Thing::RandR(); if (R < 0.1 || (time(0) - _Now > 1 && R < 0.5)) Boom();
-   }
-}
-
-// The object's type.
-TypeT Spark::Type() const { return SparkOT; }
-
-// class Thrust: public methods
-// ────────────────────────────
-// Make a new Thrust object.
-Thrust::Thrust(Engine &Owner): Thing(Owner) {
-// Create the points.
-   _Points = 2, _Point = new ObjPos[_Points];
-   _Point[0] = ObjPos(0.0, +1.0), _Point[1] = ObjPos(0.0, -1.0);
-// Get the collision radius.
-   _Radius = _SizeUp();
-}
-
-// Is it a rock?
-bool Thrust::Rocky() const { return false; }
-
-// Can it occupy the Kuypier region?
-bool Thrust::Kuypier() const { return true; }
-
-// Would a collision with Other be fatal?
-bool Thrust::Lethal(const Thing &/*Other*/) const { return false; }
-
-// Move the object for a very limited time, so as to avoid long thrust trails across the screen.
-void Thrust::Tick() {
-   if (!_Dead) _Tick(), _Dead = _Ticks > 1;
-}
-
-// The object's score, type, mass and termination routine.
-// Zero mass means transparent.
-// (No explosion on termination: just die.)
-int Thrust::Score() const { return 0; }
-TypeT Thrust::Type() const { return ThrustOT; }
-double Thrust::Mass() const { return 0; }
-void Thrust::Boom() { _Dead = true; }
+double Lance::Mass() const { return TypeMass; }
+void Lance::Boom() { SetDead(); }
 
 // class Label: public methods
 // ───────────────────────────
@@ -541,17 +438,17 @@ int Label::GetLife() const { return _Life; }
 void Label::SetLife(int Life) { _Life = Life; }
 
 // Is it a rock?
-bool Label::Rocky() const { return false; }
+bool Label::Rocky() const { return TypeRocky; }
 
 // Can it occupy the Kuypier region?
-bool Label::Kuypier() const { return false; }
+bool Label::Kuypier() const { return TypeKuypier; }
 
 // Would a collision with Other be fatal?
 bool Label::Lethal(const Thing &/*Other*/) const { return false; }
 
 // Move the object for a limited time.
 void Label::Tick() {
-   if (!_Dead) _Tick(), _Dead = time(0) - _Now > _Life;
+   if (!GetDead()) _Tick(), SetDead(_Age() > _Life);
 }
 
 // The object's score, type, mass and termination routine.
@@ -559,5 +456,5 @@ void Label::Tick() {
 // (No explosion on termination: just die.)
 int Label::Score() const { return 0; }
 TypeT Label::Type() const { return LabelOT; }
-double Label::Mass() const { return 0; }
-void Label::Boom() { _Dead = true; }
+double Label::Mass() const { return TypeMass; }
+void Label::Boom() { SetDead(); }
@@ -3,50 +3,93 @@
 
 // Asteroid Style Game: The objects to hold the state of the game artifacts.
 // Copyright (c) 2009 Big Angry Dog, (c) 2016-2018 Darth Ninja, (c) 2021 Darth Spectra
-#include <string>
 #include <complex>
-#include <time.h>
 
 namespace Asteroid {
 class Engine;
+class Store;
 
 // Object position type, borrow complex type and user real as X, and imag as Y.
 typedef std::complex<double> ObjPos;
 
 // Object type IDs.
 enum TypeT { NoOT = 0, BoulderOT, StoneOT, PebbleOT, ShipOT, AlienOT, LanceOT, DebrisOT, SparkOT, ThrustOT, LabelOT };
+// The number of object types, including NoOT.
+const int TypeN = LabelOT + 1;
 
 // Label font size.
 enum FontT { SmallLF = 0, MediumLF, LargeLF, HugeBoldLF };
+// The number of font sizes.
+const int FontN = HugeBoldLF + 1;
+
+// Shape IDs (Shapes.h).
+enum ShapeT: int;
+
+// Object handles: references to objects which stay valid however the engine reorders its roster,
+// and which go stale (Engine::Find() gives nullptr) once the object is gone, rather than dangle.
+// Ix is the object's entry in the engine's handle table and Gen the generation in which the entry was issued; Gen == 0 is the null handle.
+struct Handle {
+   int Ix; unsigned Gen;
+   Handle(): Ix(-1), Gen(0) { }
+   Handle(int Ix, unsigned Gen): Ix(Ix), Gen(Gen) { }
+   bool operator==(const Handle &H) const { return Ix == H.Ix && Gen == H.Gen; }
+   bool operator!=(const Handle &H) const { return !(*this == H); }
+};
+
+// The most points in any object's rendering, and the longest caption (including its terminating null).
+// Objects hold their captions in place, rather than on the heap, so that they own no resources and may be pooled.
+const int MaxPoints = 21, MaxCaption = 32;
 
 // The game object abstract base class
 // ───────────────────────────────────
-class Thing { // → Rock, Ship, Alien, Lance, Debris, Thrust, Label
+// Each concrete class also gives its mass, and whether it is rocky and may roam the Kuypier region, as compile-time constants
+// (TypeMass, TypeRocky and TypeKuypier), which its Mass(), Rocky() and Kuypier() return, and which the engine's type traits (Traits.h) are made from.
+// The position, orientation (velocity), radius and dead flag are kept in the owner's store (Store.h), in row _Row;
+// the rest of the object's state is kept here.
+// The points are the object's model, which is one of the shapes in the shape library (Shapes.h), shared by all the objects that look alike;
+// the object holds only the shape's ID, _Shape, and its angle, _Angle, by which the model is turned when it is drawn.
+// Spinning an object only changes its angle, and the points never pick up rounding errors from being turned over and over.
+class Thing { // → Rock, Ship, Alien, Lance, Label
+friend class Engine;
+friend class Store;
 protected:
-   bool _Dead;
-   double _Radius, _Twist;
+   Handle _Id;
+   size_t _Row;
+   Store *_Store;
+   double _Twist, _Angle;
+   mutable double _TurnAngle; mutable ObjPos _Turn; // The cached turn (cos, sin) for the angle _TurnAngle.
    Engine *_Owner;
-   int _Points, _Ticks;
-   time_t _Now;
-   ObjPos *_Point;
-   std::string _Caption;
+   ShapeT _Shape;
+   int _Ticks;
+   int _Now; // The creation time, by the engine clock.
+   char _Caption[MaxCaption];
    FontT _Pts;
-   double _SizeUp() const;
+   int _Age() const;
+   void _SetShape(ShapeT Shape);
+   void _SetRadius(double Radius);
    void _Replicate(TypeT T, int N, const double &SpeedUp = 1.0);
    void _Tick();
 public:
-   ObjPos _Pos, _Dir; // The position and orientation vectors.
    Thing(Engine &Owner);
    virtual ~Thing();
    bool GetDead() const;
    void SetDead(bool Dead = true);
    Engine *GetOwner() const;
+   Handle GetHandle() const;
+   ObjPos GetPos() const;
+   void SetPos(const ObjPos &Pos);
+   ObjPos GetDir() const;
+   void SetDir(const ObjPos &Dir);
    double GetRadius() const;
    void Rotate(const double &Rad);
+   double GetAngle() const;
+   void SetAngle(double Rad);
+   void SetAngle(double Rad, const ObjPos &Turn);
+   ShapeT GetShape() const;
    int GetPoints() const;
    ObjPos PosPoints(int Points) const;
-   std::string GetCaption() const;
-   void SetCaption(const std::string &Caption);
+   const char *GetCaption() const;
+   void SetCaption(const char *Caption);
    FontT GetPts() const;
    void SetPts(FontT Pts);
 // Pure virtual methods which define the behavior of the object in derived classes.
@@ -58,8 +101,11 @@ public:
    virtual TypeT Type() const = 0;
    virtual double Mass() const = 0;
    virtual void Boom() = 0;
-   static double RandR();
-   static bool RandB(double Prob = 0.5);
+   double RandR() const;
+   bool RandB(double Prob = 0.5) const;
+   static ObjPos Turned(const ObjPos &Pos, const ObjPos &Turn) {
+      return ObjPos(Pos.real()*Turn.real() - Pos.imag()*Turn.imag(), Pos.real()*Turn.imag() + Pos.imag()*Turn.real());
+   }
    static void RotateVector(ObjPos &Pos, double Rad);
    static void LimitAbs(ObjPos &Pos, const double A);
 };
@@ -67,8 +113,10 @@ public:
 // The rock object abstract base class
 // ───────────────────────────────────
 class Rock: public Thing { // → Boulder, Stone, Pebble.
+public:
+   static constexpr bool TypeRocky = true, TypeKuypier = true;
 protected:
-   void _Sculpt(const double &Scale);
+   void _Sculpt(ShapeT Bank, const double &Twist);
 public:
    Rock(Engine &Owner);
    virtual bool Rocky() const;
@@ -79,6 +127,7 @@ public:
 
 class Boulder: public Rock {
 public:
+   static constexpr double TypeMass = 300.0;
    Boulder(Engine &Owner);
    virtual int Score() const;
    virtual TypeT Type() const;
@@ -88,6 +137,7 @@ public:
 
 class Stone: public Rock {
 public:
+   static constexpr double TypeMass = 200.0;
    Stone(Engine &Owner);
    virtual int Score() const;
    virtual TypeT Type() const;
@@ -97,6 +147,7 @@ public:
 
 class Pebble: public Rock {
 public:
+   static constexpr double TypeMass = 125.0;
    Pebble(Engine &Owner);
    virtual int Score() const;
    virtual TypeT Type() const;
@@ -105,12 +156,15 @@ public:
 };
 
 class Ship: public Thing {
+friend class Engine; // For its snapshots.
+public:
+   static constexpr bool TypeRocky = false, TypeKuypier = false;
+   static constexpr double TypeMass = 10.0;
 private:
-   ObjPos _NosePos, _ThrustPos, _ThrustPlane;
-   double _Orient;
+   int _Orient; // In steps of ShipRotateRate degrees, in [0, ShipTurns).
    int _Spin, _FireCharge;
    bool _Pushing, _Firing, _FireLock, _JustFired;
-   void _ResetPoints();
+   void _SetOrient(int Orient);
 public:
    Ship(Engine &Owner);
    virtual bool Rocky() const;
@@ -131,6 +185,9 @@ public:
 };
 
 class Alien: public Thing {
+public:
+   static constexpr bool TypeRocky = false, TypeKuypier = true;
+   static constexpr double TypeMass = 15.0;
 private:
    Thing *_Neighbor() const;
    ObjPos Push() const;
@@ -148,6 +205,8 @@ public:
 
 class Lance: public Thing {
 public:
+   static constexpr bool TypeRocky = false, TypeKuypier = false;
+   static constexpr double TypeMass = 1.0;
    Lance(Engine &Owner);
    virtual bool Rocky() const;
    virtual bool Kuypier() const;
@@ -159,40 +218,10 @@ public:
    virtual void Boom();
 };
 
-class Debris: public Thing { // → Spark
-public:
-   Debris(Engine &Owner);
-   virtual bool Rocky() const;
-   virtual bool Kuypier() const;
-   virtual bool Lethal(const Thing &Other) const;
-   virtual void Tick();
-   virtual int Score() const;
-   virtual TypeT Type() const;
-   virtual double Mass() const;
-   virtual void Boom();
-};
-
-class Spark: public Debris {
-public:
-   Spark(Engine &Owner);
-   virtual void Tick();
-   virtual TypeT Type() const;
-};
-
-class Thrust: public Thing {
-public:
-   Thrust(Engine &Owner);
-   virtual bool Rocky() const;
-   virtual bool Kuypier() const;
-   virtual bool Lethal(const Thing &Other) const;
-   virtual void Tick();
-   virtual int Score() const;
-   virtual TypeT Type() const;
-   virtual double Mass() const;
-   virtual void Boom();
-};
-
 class Label: public Thing {
+public:
+   static constexpr bool TypeRocky = false, TypeKuypier = false;
+   static constexpr double TypeMass = 0.0;
 private:
    int _Life; // Lifetime (in seconds).
 public:
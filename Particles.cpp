@@ -0,0 +1,76 @@
+// Asteroid Style Game: The particle system, for the sparks, debris and thrust that decorate the game.
+// Copyright (c) 2021 Darth Spectra
+#include "Particles.h"
+#include "Kernel.h"
+
+using namespace std;
+using namespace Asteroid;
+
+#ifdef M_PI
+static const double TwoPi = 2.0*M_PI; // 2π
+#else
+static const double TwoPi = 6.28318530717958648;
+#endif
+
+// class Particles: public methods
+// ───────────────────────────────
+// Make a new, empty, Particles object, with all its storage set aside up front.
+// Every particle may roam the Kuypier region, so the margin mask is set once and for all.
+Particles::Particles():
+   _X(MaxParticles), _Y(MaxParticles), _DX(MaxParticles), _DY(MaxParticles),
+   _Angle(MaxParticles), _Twist(MaxParticles), _Radius(MaxParticles), _Kuyp(MaxParticles, 1.0),
+   _Expire(MaxParticles), _Type(MaxParticles), _Shape(MaxParticles)
+{
+   _Now = 0, Clear();
+}
+
+// Remove all the particles.
+void Particles::Clear() {
+   _Head = 0, _Used = 0, _Live = 0;
+   for (int T = 0; T < TypeN; T++) _Count[T] = 0;
+}
+
+// Add a type-T particle with the given shape at Pos, moving by Dir and spinning by Twist radians per tick from Angle,
+// to be in flight until the engine clock reaches Expire.
+void Particles::Add(TypeT T, ShapeT Shape, const ObjPos &Pos, const ObjPos &Dir, double Angle, double Twist, int Expire) {
+   size_t n = _Head;
+   if (n < _Used && _Now < _Expire[n]) _Live--, _Count[_Type[n]]--; // Crowding out the oldest.
+   _X[n] = Pos.real(), _Y[n] = Pos.imag(), _DX[n] = Dir.real(), _DY[n] = Dir.imag();
+   _Angle[n] = Angle, _Twist[n] = Twist, _Radius[n] = ShapeOf(Shape).Radius;
+   _Expire[n] = Expire, _Type[n] = T, _Shape[n] = Shape;
+   if (++_Head >= (size_t)MaxParticles) _Head = 0;
+   if (_Used < (size_t)MaxParticles) _Used++;
+   _Live++, _Count[T]++;
+}
+
+// Move, spin and wrap every particle on the engine clock tick Now, in the play area Xs × Ys with a Kuypier margin of KX × KY.
+// Expired particles are moved along with the rest, since it costs less than picking them out.
+void Particles::Tick(int Now, double Xs, double Ys, double KX, double KY) {
+   _Now = Now;
+   Integrate(_X.data(), _Y.data(), _DX.data(), _DY.data(), _Used);
+   double *Angle = _Angle.data(); const double *Twist = _Twist.data();
+   for (size_t n = 0; n < _Used; n++) if (Twist[n] != 0.0) Angle[n] = fmod(Angle[n] + Twist[n], TwoPi);
+   Wrap(_X.data(), _Y.data(), _Kuyp.data(), _Used, Xs, Ys, KX, KY);
+   _Live = 0;
+   for (int T = 0; T < TypeN; T++) _Count[T] = 0;
+   for (size_t n = 0; n < _Used; n++) if (_Now < _Expire[n]) _Live++, _Count[_Type[n]]++;
+// Once they have all gone, start the ring over from the beginning, so that quiet spells cost nothing.
+   if (_Live == 0) Clear();
+}
+
+// A lance of the given Radius at Pos: knock out the first piece of debris or spark that it touches, if any, and tell whether it did.
+// A lance is spent on the first thing that it hits.
+bool Particles::Hit(const ObjPos &Pos, double Radius) {
+   for (size_t n = 0; n < _Used; n++) {
+      if (_Now >= _Expire[n] || (_Type[n] != DebrisOT && _Type[n] != SparkOT)) continue;
+      if (abs(ObjPos(_X[n], _Y[n]) - Pos) <= Radius + _Radius[n]) {
+         _Expire[n] = _Now, _Live--, _Count[_Type[n]]--;
+         return true;
+      }
+   }
+   return false;
+}
+
+// The number of particles in flight: in all, and of type T.
+size_t Particles::Size() const { return _Live; }
+int Particles::Count(TypeT T) const { return _Count[T]; }
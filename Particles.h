@@ -0,0 +1,59 @@
+#ifndef OnceOnlyParticles_h
+#define OnceOnlyParticles_h
+
+// Asteroid Style Game: The particle system, for the sparks, debris and thrust that decorate the game.
+// Copyright (c) 2021 Darth Spectra
+#include <math.h>
+#include <vector>
+#include "Objects.h"
+#include "Shapes.h"
+
+namespace Asteroid {
+// The number of particles that may be in flight at once.
+const int MaxParticles = 512;
+
+// Is a type-T object a particle, rather than a game object?
+inline bool Particulate(TypeT T) { return T == DebrisOT || T == SparkOT || T == ThrustOT; }
+
+// The particle system
+// ───────────────────
+// Particles are not game objects: they have no behavior of their own, no handle and no place in the engine's roster.
+// Each has a position, velocity, angle and spin, a shape from the shape library and the tick at which it expires,
+// all held column by column in a ring of fixed capacity: when the ring is full, a new particle replaces the oldest.
+// The whole ring is moved, spun and wrapped around the play area (with the Kuypier margin) in bulk, by the motion kernels (Kernel.h),
+// and a particle simply stops being drawn when the engine clock reaches its expiry, so nothing is ever freed.
+// Particles do not rebound off anything, but debris and sparks are still knocked out by the ship's lances, see Hit().
+class Particles {
+friend class Engine; // For its snapshots.
+private:
+   std::vector<double> _X, _Y, _DX, _DY, _Angle, _Twist, _Radius, _Kuyp;
+   std::vector<int> _Expire;
+   std::vector<unsigned char> _Type, _Shape;
+   size_t _Head, _Used, _Live;
+   int _Count[TypeN]; // The number in flight, by type.
+   int _Now;
+public:
+   Particles();
+   void Clear();
+   void Add(TypeT T, ShapeT Shape, const ObjPos &Pos, const ObjPos &Dir, double Angle, double Twist, int Expire);
+   void Tick(int Now, double Xs, double Ys, double KX, double KY);
+   bool Hit(const ObjPos &Pos, double Radius);
+   size_t Size() const;
+   int Count(TypeT T) const;
+// Call Line(P0, P1, Dir) for each line segment in the outline of each particle in flight, with its velocity Dir, for drawing them all in one batch.
+   template <typename Fn> void Lines(Fn Line) const {
+      for (size_t n = 0; n < _Used; n++) {
+         if (_Now >= _Expire[n]) continue;
+         const Shape &S = ShapeOf((ShapeT)_Shape[n]);
+         ObjPos Pos(_X[n], _Y[n]), Turn(cos(_Angle[n]), sin(_Angle[n])), Dir(_DX[n], _DY[n]);
+         ObjPos P0 = Thing::Turned(S.Point[0], Turn) + Pos;
+         for (int p = 1; p < S.Points; p++) {
+            ObjPos P1 = Thing::Turned(S.Point[p], Turn) + Pos;
+            Line(P0, P1, Dir), P0 = P1;
+         }
+      }
+   }
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,48 @@
+// Asteroid Style Game: The fixed-size storage pool for game objects.
+// Copyright (c) 2021 Darth Spectra
+#include <new>
+#include "Pool.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// The slot alignment; enough for any of the game objects.
+static const size_t SlotAlign = 16;
+
+// class Pool: public methods
+// ──────────────────────────
+// Make a new Pool object, for slots of Slot bytes, taken from the heap Slots at a time.
+Pool::Pool(size_t Slot, size_t Slots/* = 256*/) {
+   if (Slot < sizeof(void *)) Slot = sizeof(void *);
+   _Slot = (Slot + SlotAlign - 1)/SlotAlign*SlotAlign, _Slots = Slots > 0? Slots: 1;
+   _Block = 0, _Used = 0, _Free = nullptr, _Allocs = 0;
+}
+
+// Free the Pool object and all of its blocks.
+Pool::~Pool() {
+   try {
+      for (size_t B = 0; B < _Blocks.size(); B++) ::operator delete(_Blocks[B]);
+   } catch(...) { }
+}
+
+// Get a slot: a freed one, if there are any, else the next unused one, else one from a new block.
+void *Pool::Get() {
+   if (_Free != nullptr) {
+      void *Slot = _Free; _Free = *static_cast<void **>(Slot);
+      return Slot;
+   }
+   if (_Block < _Blocks.size() && _Used >= _Slots) _Block++, _Used = 0;
+   if (_Block >= _Blocks.size()) _Blocks.push_back(static_cast<char *>(::operator new(_Slot*_Slots))), _Allocs++, _Used = 0;
+   return _Blocks[_Block] + _Slot*_Used++;
+}
+
+// Put a slot back for reuse; the object in it should already have been destroyed.
+void Pool::Put(void *Slot) {
+   if (Slot != nullptr) *static_cast<void **>(Slot) = _Free, _Free = Slot;
+}
+
+// Release all the slots at once, keeping the blocks.
+void Pool::Reset() { _Free = nullptr, _Block = 0, _Used = 0; }
+
+// The number of blocks taken from the heap, over the life of the pool.
+long Pool::GetAllocs() const { return _Allocs; }
@@ -0,0 +1,32 @@
+#ifndef OnceOnlyPool_h
+#define OnceOnlyPool_h
+
+// Asteroid Style Game: The fixed-size storage pool for game objects.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <vector>
+
+namespace Asteroid {
+// The object pool
+// ───────────────
+// Slots of one fixed size are carved out of large blocks, and freed slots are kept on a list for reuse,
+// so once the pool has grown to the peak number of objects in play, getting and putting slots never touches the heap.
+// Reset() releases every slot at once, in constant time, keeping the blocks for the next round;
+// this is only safe for objects that hold no resources of their own.
+class Pool {
+private:
+   std::vector<char *> _Blocks;
+   size_t _Slot, _Slots, _Block, _Used;
+   void *_Free;
+   long _Allocs;
+public:
+   Pool(size_t Slot, size_t Slots = 256);
+   ~Pool();
+   void *Get();
+   void Put(void *Slot);
+   void Reset();
+   long GetAllocs() const;
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,77 @@
+// Asteroid Style Game: The built-in profiler, for timing the phases of the engine's tick and the parts of the game's frame.
+// Copyright (c) 2021 Darth Spectra
+#include <algorithm>
+#include "Profile.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// class Profile: public methods
+// ─────────────────────────────
+// Make a new, empty, Profile object.
+Profile::Profile() { Clear(); }
+
+// Drop all the samples and tallies.
+void Profile::Clear() {
+   for (int P = 0; P < ProbeN; P++) _Next[P] = 0, _Used[P] = 0, _Tally[P] = 0.0;
+}
+
+// Add the sample X for probe P, in place of its oldest, once its ring is full.
+void Profile::Add(ProbeT P, double X) {
+   _Sample[P][_Next[P]] = X;
+   if (++_Next[P] >= ProfileSamples) _Next[P] = 0;
+   if (_Used[P] < ProfileSamples) _Used[P]++;
+}
+
+// Take probe P's running tally as a sample, and start it over.
+void Profile::Tally(ProbeT P) { Add(P, _Tally[P]), _Tally[P] = 0.0; }
+
+// The number of samples held for probe P.
+int Profile::Samples(ProbeT P) const { return _Used[P]; }
+
+// The latest sample for probe P, or 0 if there are none.
+double Profile::Last(ProbeT P) const {
+   return _Used[P] == 0? 0.0: _Sample[P][_Next[P] > 0? _Next[P] - 1: ProfileSamples - 1];
+}
+
+// The Q-th quantile of the samples held for probe P, for Q in [0, 1] (0.5 for the median), or 0 if there are none.
+// This is meant to be called a few times a frame, at most, so the samples are simply copied out and partly sorted.
+double Profile::Percentile(ProbeT P, double Q) const {
+   int N = _Used[P]; if (N == 0) return 0.0;
+   double Xs[ProfileSamples]; copy(_Sample[P], _Sample[P] + N, Xs);
+   int K = (int)(Q*(N - 1) + 0.5); K = K < 0? 0: K >= N? N - 1: K;
+   nth_element(Xs, Xs + K, Xs + N);
+   return Xs[K];
+}
+
+// The name of probe P, for reports.
+const char *Profile::Name(ProbeT P) {
+   static const char *const Names[ProbeN] = {
+      "tick", "sweep", "move", "objtick", "collide", "strike", "spawn", "wrap",
+      "frame", "geometry", "text", "hud", "poll", "paint", "sound", "pairs", "draws"
+   };
+   return P >= 0 && P < ProbeN? Names[P]: "?";
+}
+
+// struct PercentilesT: public methods
+// ──────────────────────────────────
+// Make a new PercentilesT object, with no samples.
+PercentilesT::PercentilesT() {
+   for (int P = 0; P < ProbeN; P++) Samples[P] = 0, P50[P] = P95[P] = P99[P] = 0.0;
+}
+
+// Take the percentiles of each of Prof's probes that has any samples (on the thread that owns Prof).
+void PercentilesT::Take(const Profile &Prof) {
+   for (int P = 0; P < ProbeN; P++) {
+      ProbeT Pr = (ProbeT)P;
+      Samples[P] = Prof.Samples(Pr);
+      if (Samples[P] == 0) P50[P] = P95[P] = P99[P] = 0.0;
+      else P50[P] = Prof.Percentile(Pr, 0.5), P95[P] = Prof.Percentile(Pr, 0.95), P99[P] = Prof.Percentile(Pr, 0.99);
+   }
+}
+
+// The calling thread's profiler.
+Profile &Asteroid::Profiler() {
+   static thread_local Profile Prof;
+   return Prof;
+}
@@ -0,0 +1,82 @@
+#ifndef OnceOnlyProfile_h
+#define OnceOnlyProfile_h
+
+// Asteroid Style Game: The built-in profiler, for timing the phases of the engine's tick and the parts of the game's frame.
+// Copyright (c) 2021 Darth Spectra
+#include <chrono>
+
+namespace Asteroid {
+// The probes: the spans of code that are timed, in nanoseconds, and the quantities that are tallied, once a tick or a frame.
+enum ProbeT {
+   TickPR, SweepPR, MovePR, ObjTickPR, CollidePR, StrikePR, SpawnPR, WrapPR, // The engine's tick, and the phases of its state tick.
+   FramePR, GeometryPR, TextPR, HudPR, // The game's frame, and its parts.
+   PollPR, PaintPR, SoundPR, // The game's poll, its paint event and its sound dispatch.
+   PairsPR, DrawsPR, // The number of collision pairs tested in a tick, and of draw calls made in a frame.
+   ProbeN
+};
+
+// The number of samples held for each probe, from which its percentiles are taken.
+const int ProfileSamples = 256;
+
+// The profiler
+// ────────────
+// Each probe keeps its latest ProfileSamples samples in a ring, so that its percentiles roll along with the game.
+// The probes are placed in the code with the Profiled(), ProfileCount() and ProfileTally() macros,
+// which are compiled in only when PROFILE is defined (qmake CONFIG+=profile); otherwise they vanish, and cost nothing.
+// The profiler itself is always there to be read, but it is then left empty.
+// A profiler is not locked, and is to be written and read only by the one thread that owns it (Profiler()).
+class Profile {
+private:
+   double _Sample[ProbeN][ProfileSamples];
+   int _Next[ProbeN], _Used[ProbeN];
+   double _Tally[ProbeN];
+public:
+   Profile();
+   void Clear();
+   void Add(ProbeT P, double X);
+   void Count(ProbeT P, double N) { _Tally[P] += N; }
+   void Tally(ProbeT P);
+   int Samples(ProbeT P) const;
+   double Last(ProbeT P) const;
+   double Percentile(ProbeT P, double Q) const;
+   static const char *Name(ProbeT P);
+};
+
+// The calling thread's profiler. Each thread has one of its own, so that the engine's probes, on the simulation thread (Sim.h),
+// and the game's, on its own thread, are never written by one thread while read by another;
+// the engine's percentiles are passed on to the game in its render snapshots (PercentilesT), rather than read from the simulation thread's profiler.
+Profile &Profiler();
+
+// The percentiles of a profiler's probes, as taken at one time, to be handed on from one thread to another.
+// Only the probes that had any samples are taken; the rest are left with no samples, and percentiles of 0.
+struct PercentilesT {
+   int Samples[ProbeN];
+   double P50[ProbeN], P95[ProbeN], P99[ProbeN];
+   PercentilesT();
+   void Take(const Profile &Prof);
+};
+
+// Time the rest of the enclosing scope, as a sample for probe P.
+class ProfileSpan {
+private:
+   ProbeT _Probe;
+   std::chrono::steady_clock::time_point _T0;
+public:
+   explicit ProfileSpan(ProbeT P): _Probe(P), _T0(std::chrono::steady_clock::now()) { }
+   ~ProfileSpan() { Profiler().Add(_Probe, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _T0).count()); }
+};
+} // end of namespace Asteroid
+
+// Profiled(P): time the rest of the scope for probe P (once per scope).
+// ProfileCount(P, N): add N to probe P's running tally; ProfileTally(P): take the tally as a sample, and start it over.
+#ifdef PROFILE
+#   define Profiled(P)		Asteroid::ProfileSpan ProfiledSpan(P)
+#   define ProfileCount(P, N)	(Asteroid::Profiler().Count((P), (double)(N)))
+#   define ProfileTally(P)	(Asteroid::Profiler().Tally(P))
+#else
+#   define Profiled(P)		((void)0)
+#   define ProfileCount(P, N)	((void)0)
+#   define ProfileTally(P)	((void)0)
+#endif
+
+#endif // OnceOnly
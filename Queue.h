@@ -0,0 +1,42 @@
+#ifndef OnceOnlyQueue_h
+#define OnceOnlyQueue_h
+
+// Asteroid Style Game: A lock-free queue, for passing items from one thread to another.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <atomic>
+
+namespace Asteroid {
+// The single-producer, single-consumer queue
+// ──────────────────────────────────────────
+// A ring of N items (N a power of 2), with one thread pushing items in and one other taking them out, neither of them ever waiting on a lock.
+// The head is moved only by the producer, and the tail only by the consumer, each with a release, after its item has been written or read;
+// they are padded out onto cache lines of their own, so that the two threads do not contend for them,
+// and each side keeps the last index of the other that it has seen, so that it only looks at the other's cache line when the ring seems full, or empty.
+template <typename T, size_t N> class Queue {
+   static_assert(N > 0 && (N&(N - 1)) == 0, "The queue's size must be a power of 2.");
+private:
+   T _Ring[N];
+   char _Pad0[64]; std::atomic<size_t> _Head; size_t _TailSeen; // The producer's.
+   char _Pad1[64]; std::atomic<size_t> _Tail; size_t _HeadSeen; // The consumer's.
+   char _Pad2[64];
+public:
+   Queue(): _Head(0), _TailSeen(0), _Tail(0), _HeadSeen(0) { }
+// Push Item in, or tell that the queue is full (on the producer's thread only).
+   bool Push(const T &Item) {
+      size_t Head = _Head.load(std::memory_order_relaxed);
+      if (Head - _TailSeen == N && Head - (_TailSeen = _Tail.load(std::memory_order_acquire)) == N) return false;
+      _Ring[Head&(N - 1)] = Item, _Head.store(Head + 1, std::memory_order_release);
+      return true;
+   }
+// Take the oldest item out into Item, or tell that the queue is empty (on the consumer's thread only).
+   bool Pop(T &Item) {
+      size_t Tail = _Tail.load(std::memory_order_relaxed);
+      if (Tail == _HeadSeen && Tail == (_HeadSeen = _Head.load(std::memory_order_acquire))) return false;
+      Item = _Ring[Tail&(N - 1)], _Tail.store(Tail + 1, std::memory_order_release);
+      return true;
+   }
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
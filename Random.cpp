@@ -0,0 +1,41 @@
+// Asteroid Style Game: The random number generator.
+// Copyright (c) 2021 Darth Spectra
+#include "Random.h"
+
+using namespace Asteroid;
+
+// class Random: public methods
+// ────────────────────────────
+// Make a new Random object, seeded with Seed.
+Random::Random(uint64_t Seed/* = 1*/) { this->Seed(Seed); }
+
+// Restart the sequence from Seed; the state is filled out from the seed by splitmix64, which never leaves it all zero.
+void Random::Seed(uint64_t Seed) {
+   for (int n = 0; n < 4; n++) {
+      uint64_t Z = (Seed += 0x9e3779b97f4a7c15);
+      Z = (Z ^ (Z >> 30))*0xbf58476d1ce4e5b9, Z = (Z ^ (Z >> 27))*0x94d049bb133111eb;
+      _State[n] = Z ^ (Z >> 31);
+   }
+}
+
+// Get/set the generator's state, to save and restore it exactly, part way through its sequence.
+// A state of all zeros is never reached by the generator, and is not allowed.
+void Random::GetState(uint64_t State[4]) const {
+   for (int n = 0; n < 4; n++) State[n] = _State[n];
+}
+
+void Random::SetState(const uint64_t State[4]) {
+   for (int n = 0; n < 4; n++) _State[n] = State[n];
+}
+
+// Fill R[0], …, R[N - 1] with uniformly-distributed random numbers over [0, 1).
+// The values are the same as N calls to RandR(), but drawn in one tight loop, for objects that need a batch of them at once.
+void Random::Fill(double *R, int N) {
+   uint64_t S0 = _State[0], S1 = _State[1], S2 = _State[2], S3 = _State[3];
+   for (int n = 0; n < N; n++) {
+      uint64_t Bits = _Rotl(S1*5, 7)*9, T = S1 << 17;
+      S2 ^= S0, S3 ^= S1, S1 ^= S2, S0 ^= S3, S2 ^= T, S3 = _Rotl(S3, 45);
+      R[n] = (Bits >> 11)*(1.0/9007199254740992.0);
+   }
+   _State[0] = S0, _State[1] = S1, _State[2] = S2, _State[3] = S3;
+}
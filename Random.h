@@ -0,0 +1,38 @@
+#ifndef OnceOnlyRandom_h
+#define OnceOnlyRandom_h
+
+// Asteroid Style Game: The random number generator.
+// Copyright (c) 2021 Darth Spectra
+#include <stdint.h>
+
+namespace Asteroid {
+// The random number generator
+// ───────────────────────────
+// Each engine owns one of these, so that engines in the same process run independently of each other,
+// and a game is reproduced exactly from its seed.
+// The generator is xoshiro256** (Blackman and Vigna), seeded by splitmix64: it is fast, small and has no global state.
+class Random {
+private:
+   uint64_t _State[4];
+   static uint64_t _Rotl(uint64_t X, int K) { return (X << K) | (X >> (64 - K)); }
+public:
+   Random(uint64_t Seed = 1);
+   void Seed(uint64_t Seed);
+   void GetState(uint64_t State[4]) const;
+   void SetState(const uint64_t State[4]);
+// The next 64 random bits.
+   uint64_t Next() {
+      uint64_t Bits = _Rotl(_State[1]*5, 7)*9, T = _State[1] << 17;
+      _State[2] ^= _State[0], _State[3] ^= _State[1], _State[1] ^= _State[2], _State[0] ^= _State[3];
+      _State[2] ^= T, _State[3] = _Rotl(_State[3], 45);
+      return Bits;
+   }
+// A uniformly-distributed random number over [0, 1).
+   double RandR() { return (Next() >> 11)*(1.0/9007199254740992.0); }
+// A random boolean value with probability Prob for ‟true”.
+   bool RandB(double Prob = 0.5) { return RandR() < Prob; }
+   void Fill(double *R, int N);
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
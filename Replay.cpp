@@ -0,0 +1,259 @@
+// Asteroid Style Game: The replay recorder and player, for reproducing a game exactly from its inputs.
+// Copyright (c) 2021 Darth Spectra
+#include <string.h>
+#include "Replay.h"
+#include "Engine.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// The file's magic number, which leads off its header.
+static const char ReplayMagic[4] = { 'A', 'S', 'T', 'R' };
+
+// The raw bits of a double, and back.
+static uint64_t BitsOf(double X) { uint64_t N; memcpy(&N, &X, sizeof N); return N; }
+static double DoubleOf(uint64_t N) { double X; memcpy(&X, &N, sizeof X); return X; }
+
+// The varint decoders, for the player: each reads from Data[At] on, advances At, and tells whether there was enough data.
+static bool GetByte(const vector<unsigned char> &Data, size_t &At, unsigned &Byte) {
+   if (At >= Data.size()) return false;
+   Byte = Data[At++];
+   return true;
+}
+
+static bool GetVar(const vector<unsigned char> &Data, size_t &At, uint64_t &N) {
+   N = 0;
+   for (int Shift = 0; Shift < 64; Shift += 7) {
+      unsigned Byte; if (!GetByte(Data, At, Byte)) return false;
+      N |= (uint64_t)(Byte&0x7f) << Shift;
+      if ((Byte&0x80) == 0) return true;
+   }
+   return false;
+}
+
+static bool GetZig(const vector<unsigned char> &Data, size_t &At, int64_t &N) {
+   uint64_t Z; if (!GetVar(Data, At, Z)) return false;
+   N = (int64_t)(Z >> 1) ^ -(int64_t)(Z&1);
+   return true;
+}
+
+static bool GetBits(const vector<unsigned char> &Data, size_t &At, uint64_t &N) {
+   if (At > Data.size() || Data.size() - At < 8) return false;
+   N = 0;
+   for (int n = 0; n < 8; n++) N |= (uint64_t)Data[At++] << 8*n;
+   return true;
+}
+
+// class Recorder: private methods
+// ───────────────────────────────
+// The encoders: a byte, an unsigned varint (7 bits a byte, low bits first), a signed varint (zigzagged) and 64 raw bits (low byte first).
+void Recorder::_Byte(unsigned Byte) { fputc((int)(Byte&0xff), _File), _Bytes++; }
+
+void Recorder::_Var(uint64_t N) {
+   for (; N >= 0x80; N >>= 7) _Byte((unsigned)(N&0x7f) | 0x80);
+   _Byte((unsigned)N);
+}
+
+void Recorder::_Zig(int64_t N) { _Var(((uint64_t)N << 1) ^ (uint64_t)(N >> 63)); }
+
+void Recorder::_Bits(uint64_t N) {
+   for (int n = 0; n < 8; n++) _Byte((unsigned)(N >> 8*n));
+}
+
+// Start a record of the input In, at the current tick.
+void Recorder::_Record(InputT In) { _Var((uint64_t)(_Ticks - _Last)), _Byte(In), _Last = _Ticks; }
+
+// class Recorder: public methods
+// ──────────────────────────────
+// Make a new, idle, Recorder object.
+Recorder::Recorder(): _File(nullptr), _Machine(nullptr), _Ticks(0), _Last(0), _Xs(0), _Ys(0), _Bytes(0) { }
+
+// Free the Recorder object, finishing off its recording, if it is making one.
+Recorder::~Recorder() { Stop(); }
+
+// Start recording the engine E into the file at Path, and tell whether the file could be made.
+// The engine is stopped first, so that the recording starts from an idle engine, which is wholly described by the header.
+bool Recorder::Start(Engine &E, const char *Path) {
+   Stop();
+   _File = fopen(Path, "wb"); if (_File == nullptr) return false;
+   E.Stop();
+   _Machine = &E, _Ticks = 0, _Last = 0, _Bytes = 0;
+   for (int n = 0; n < 4; n++) _Byte(ReplayMagic[n]);
+   _Var(ReplayVersion);
+   uint64_t Rand[4]; E.GetRandom().GetState(Rand);
+   for (int n = 0; n < 4; n++) _Bits(Rand[n]);
+   _Bits(BitsOf(E.GetLevel()));
+   E.GetPlayDims(&_Xs, &_Ys), _Zig(_Xs), _Zig(_Ys);
+   _Zig(E.GetAlienCap()), _Zig(E.GetHiScore());
+   E.SetRecorder(this);
+   return true;
+}
+
+// Finish off the recording, with the number of ticks recorded, and close the file.
+void Recorder::Stop() {
+   if (_File == nullptr) return;
+   _Record(EndIN);
+   fclose(_File), _File = nullptr;
+   if (_Machine != nullptr) _Machine->SetRecorder(nullptr), _Machine = nullptr;
+}
+
+// Is a recording being made?
+bool Recorder::On() const { return _File != nullptr; }
+
+// Record the input In, with its arguments A and B, as made to the engine; the play area is only recorded when it changes.
+void Recorder::Note(InputT In, int A/* = 0*/, int B/* = 0*/) {
+   if (_File == nullptr) return;
+   switch (In) {
+      case SpinIN: case AlienCapIN: case BegGameIN: _Record(In), _Zig(A); break;
+      case PushIN: _Record(In), _Byte(A != 0); break;
+      case BegDemoIN: _Record(In), _Zig(A), _Zig(B); break;
+      case DimsIN:
+         if (A != _Xs || B != _Ys) _Xs = A, _Ys = B, _Record(In), _Zig(A), _Zig(B);
+      break;
+      default: _Record(In); break;
+   }
+}
+
+// Record a change to the game level.
+void Recorder::NoteLevel(double Level) {
+   if (_File != nullptr) _Record(LevelIN), _Bits(BitsOf(Level));
+}
+
+// Record a new seed for the engine's random number generator.
+void Recorder::NoteSeed(uint64_t Seed) {
+   if (_File != nullptr) _Record(SeedIN), _Bits(Seed);
+}
+
+// Count a tick; this is called by the engine at the start of each Tick(), after the inputs made since the last one.
+// Every SyncTicks ticks, record a sync point, with the engine's checksum, as it was after the inputs made up till now.
+void Recorder::Tick() {
+   if (_File == nullptr) return;
+   if (_Ticks > 0 && _Ticks%SyncTicks == 0) _Record(SyncIN), _Bits(_Machine->Checksum());
+   _Ticks++;
+}
+
+// The number of ticks, and of bytes, recorded so far.
+long Recorder::Ticks() const { return _Ticks; }
+long Recorder::Bytes() const { return _Bytes; }
+
+// class Player: private methods
+// ─────────────────────────────
+// Decode the record at Data[At], which follows a record at Tick, into R; advance At and Tick, and tell whether it was well-formed.
+bool Player::_Next(size_t &At, long &Tick, RecordT &R) const {
+   uint64_t Delta; unsigned In;
+   if (!GetVar(_Data, At, Delta) || !GetByte(_Data, At, In) || In == NoIN || In >= InputN) return false;
+   R.Tick = Tick += (long)Delta, R.In = (InputT)In, R.A = 0, R.B = 0, R.U = 0;
+   switch (R.In) {
+      case SpinIN: case AlienCapIN: case BegGameIN: return GetZig(_Data, At, R.A);
+      case PushIN: { unsigned Byte; if (!GetByte(_Data, At, Byte)) return false; R.A = Byte; return true; }
+      case BegDemoIN: case DimsIN: return GetZig(_Data, At, R.A) && GetZig(_Data, At, R.B);
+      case LevelIN: case SeedIN: case SyncIN: return GetBits(_Data, At, R.U);
+      default: return true;
+   }
+}
+
+// class Player: public methods
+// ────────────────────────────
+// Make a new, empty, Player object.
+Player::Player(): _Body(0), _At(0), _AtTick(0), _Level(0.5), _Xs(0), _Ys(0), _AlienCap(0), _HiScore(0) {
+   _Ticks = 0, _Length = 0, _Syncs = 0, _Desyncs = 0, _FirstDesync = -1;
+   for (int n = 0; n < 4; n++) _Rand[n] = 0;
+}
+
+// Load the replay in the file at Path, and tell whether it is a well-formed replay, of this version.
+// The records are all checked once, here, so that playing them back need not check them again.
+// A replay that was cut short, such as by a crash, with no end record, plays up to its last whole record.
+bool Player::Load(const char *Path) {
+   _Data.clear(), _Keys.clear(), _Length = 0;
+   FILE *InF = fopen(Path, "rb"); if (InF == nullptr) return false;
+   unsigned char Buf[0x1000];
+   for (size_t N; (N = fread(Buf, 1, sizeof Buf, InF)) > 0; ) _Data.insert(_Data.end(), Buf, Buf + N);
+   fclose(InF);
+   size_t At = 0; uint64_t Version, Level; int64_t Xs, Ys, AlienCap, HiScore;
+   if (_Data.size() < sizeof ReplayMagic || memcmp(_Data.data(), ReplayMagic, sizeof ReplayMagic) != 0) return false;
+   At += sizeof ReplayMagic;
+   if (!GetVar(_Data, At, Version) || Version != (uint64_t)ReplayVersion) return false;
+   for (int n = 0; n < 4; n++) if (!GetBits(_Data, At, _Rand[n])) return false;
+   if (!GetBits(_Data, At, Level) || !GetZig(_Data, At, Xs) || !GetZig(_Data, At, Ys)) return false;
+   if (!GetZig(_Data, At, AlienCap) || !GetZig(_Data, At, HiScore)) return false;
+   _Level = DoubleOf(Level), _Xs = (int)Xs, _Ys = (int)Ys, _AlienCap = (int)AlienCap, _HiScore = (int)HiScore;
+   _Body = At;
+   long Tick = 0; RecordT R;
+   for (size_t Last = At; At < _Data.size(); Last = At) {
+      if (!_Next(At, Tick, R)) { _Data.resize(Last); break; }
+      _Length = R.Tick;
+      if (R.In == EndIN) break;
+   }
+   _At = _Body, _AtTick = 0, _Ticks = 0, _Keys.reserve(_Length/SyncTicks + 1);
+   return true;
+}
+
+// Set the engine E up as it was at the start of the recording, and start playing from the beginning.
+// The keyframes are kept, since they will be the same, the next time through.
+void Player::Begin(Engine &E) {
+   E.Stop();
+   E.GetRandom().SetState(_Rand), E.SetLevel(_Level), E.SetPlayDims(_Xs, _Ys), E.SetAlienCap(_AlienCap), E.SetHiScore(_HiScore);
+   _At = _Body, _AtTick = 0, _Ticks = 0, _Syncs = 0, _Desyncs = 0, _FirstDesync = -1;
+}
+
+// Play one tick into the engine E: make the inputs recorded for it, check any sync point, then tick the engine.
+// Tell whether there was a tick left to play.
+bool Player::Step(Engine &E) {
+   if (Done()) return false;
+   if (_Ticks%SyncTicks == 0 && (size_t)(_Ticks/SyncTicks) == _Keys.size()) {
+      _Keys.push_back(KeyT()); KeyT &Key = _Keys.back();
+      Key.Tick = _Ticks, Key.AtTick = _AtTick, Key.Syncs = _Syncs, Key.Desyncs = _Desyncs, Key.FirstDesync = _FirstDesync, Key.At = _At;
+      Key.Snap.Take(E);
+   }
+   RecordT R;
+   for (size_t At = _At; At < _Data.size(); _At = At) {
+      long Tick = _AtTick;
+      if (!_Next(At, Tick, R) || R.Tick > _Ticks) break;
+      _AtTick = Tick;
+      switch (R.In) {
+         case SpinIN: E.SetSpin((int)R.A); break;
+         case PushIN: E.SetPushing(R.A != 0); break;
+         case FireIN: E.Fire(); break;
+         case ReLoadIN: E.ReLoad(); break;
+         case AlienIN: E.AddAlienCheat(); break;
+         case BegGameIN: E.BegGame((int)R.A); break;
+         case BegDemoIN: E.BegDemo((int)R.A, (int)R.B); break;
+         case StopIN: E.Stop(); break;
+         case LevelIN: E.SetLevel(DoubleOf(R.U)); break;
+         case DimsIN: E.SetPlayDims((int)R.A, (int)R.B); break;
+         case AlienCapIN: E.SetAlienCap((int)R.A); break;
+         case SeedIN: E.SetSeed(R.U); break;
+         case SyncIN:
+            _Syncs++;
+            if (E.Checksum() != R.U && _Desyncs++ == 0) _FirstDesync = _Ticks;
+         break;
+         default: break;
+      }
+   }
+   E.Tick(), _Ticks++;
+   return true;
+}
+
+// Play on into the engine E until tick Tick (or the end), from the latest keyframe at or before it, if that is backward or ahead.
+void Player::Seek(Engine &E, long Tick) {
+   if (!_Keys.empty()) {
+      size_t K = Tick < 0? 0: (size_t)(Tick/SyncTicks); if (K >= _Keys.size()) K = _Keys.size() - 1;
+      const KeyT &Key = _Keys[K];
+      if ((Tick < _Ticks || Key.Tick > _Ticks) && Key.Snap.Give(E))
+         _Ticks = Key.Tick, _AtTick = Key.AtTick, _Syncs = Key.Syncs, _Desyncs = Key.Desyncs, _FirstDesync = Key.FirstDesync, _At = Key.At;
+   }
+   if (Tick < _Ticks) Begin(E);
+   while (_Ticks < Tick && Step(E));
+}
+
+// Has it all been played?
+bool Player::Done() const { return _Ticks >= _Length; }
+
+// The number of ticks played so far, and in all.
+long Player::Tick() const { return _Ticks; }
+long Player::Length() const { return _Length; }
+
+// The number of sync points passed so far, the number of them at which the engine had gone astray, and the tick of the first (or -1).
+long Player::Syncs() const { return _Syncs; }
+long Player::Desyncs() const { return _Desyncs; }
+long Player::FirstDesync() const { return _FirstDesync; }
@@ -0,0 +1,94 @@
+#ifndef OnceOnlyReplay_h
+#define OnceOnlyReplay_h
+
+// Asteroid Style Game: The replay recorder and player, for reproducing a game exactly from its inputs.
+// Copyright (c) 2021 Darth Spectra
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "Snapshot.h"
+
+namespace Asteroid {
+class Engine;
+
+// The inputs to the engine that are recorded: everything that can change the course of a game.
+enum InputT {
+   NoIN = 0, SpinIN, PushIN, FireIN, ReLoadIN, AlienIN, BegGameIN, BegDemoIN, StopIN, LevelIN, DimsIN, AlienCapIN, SeedIN,
+   SyncIN, // A sync point: the engine's checksum at that tick, which the player checks its own against.
+   EndIN, // The end of the recording, and the number of ticks recorded.
+   InputN
+};
+
+// The replay format version, and the number of ticks between sync points (10 seconds of the engine clock).
+const int ReplayVersion = 1, SyncTicks = 220;
+
+// The replay recorder
+// ───────────────────
+// A replay is the engine's state at the start of the recording, followed by every input made to it, tick by tick.
+// The engine is deterministic, so that is enough to reproduce the game exactly, by replaying the inputs into an engine set up the same way.
+// Recording starts with the engine idle: Start() stops it, if need be, and writes out its random number generator's state and its settings.
+// Each input is then written as it is made, by the engine, as a record: the number of ticks since the last record, as a varint,
+// the input, as a byte, and its arguments, as varints (zigzagged, if they may be negative) or raw bits, for the level;
+// so a typical input takes 2 or 3 bytes, and the ticks without any input take none at all.
+// Every SyncTicks ticks, a sync point is written, with the engine's checksum (Engine::Checksum()), so that a player can tell if it has gone astray.
+class Recorder {
+private:
+   FILE *_File;
+   Engine *_Machine;
+   long _Ticks, _Last; // The number of ticks recorded, and the tick of the latest record.
+   int _Xs, _Ys; // The latest play area, which is only recorded when it changes.
+   long _Bytes;
+   void _Byte(unsigned Byte);
+   void _Var(uint64_t N);
+   void _Zig(int64_t N);
+   void _Bits(uint64_t N);
+   void _Record(InputT In);
+public:
+   Recorder();
+   ~Recorder();
+   bool Start(Engine &E, const char *Path);
+   void Stop();
+   bool On() const;
+   void Note(InputT In, int A = 0, int B = 0);
+   void NoteLevel(double Level);
+   void NoteSeed(uint64_t Seed);
+   void Tick();
+   long Ticks() const;
+   long Bytes() const;
+};
+
+// The replay player
+// ─────────────────
+// The player loads a whole replay, checks that it is well-formed, then feeds its inputs into an engine, tick by tick, at any speed.
+// The engine should not be in use for anything else while it is played into, nor be recording.
+// As it plays, the player keeps a keyframe every SyncTicks ticks: a snapshot of the engine (Snapshot.h), and where it was in the replay.
+// Seeking jumps to the latest keyframe at or before the tick sought, if that is backward or ahead of where the player is, then plays on from there;
+// so seeking anywhere that has been played already takes at most SyncTicks ticks, and seeking ahead plays on as fast as the engine allows.
+class Player {
+private:
+   struct RecordT { long Tick; InputT In; int64_t A, B; uint64_t U; };
+   struct KeyT { long Tick, AtTick, Syncs, Desyncs, FirstDesync; size_t At; Snapshot Snap; };
+   std::vector<KeyT> _Keys; // The keyframes, at ticks 0, SyncTicks, 2 SyncTicks, …, as far as it has played.
+   std::vector<unsigned char> _Data;
+   size_t _Body, _At; long _AtTick; // Where the records start, and the next record, and the tick of the record before it.
+   uint64_t _Rand[4];
+   double _Level;
+   int _Xs, _Ys, _AlienCap, _HiScore;
+   long _Ticks, _Length, _Syncs, _Desyncs, _FirstDesync;
+   bool _Next(size_t &At, long &Tick, RecordT &R) const;
+public:
+   Player();
+   bool Load(const char *Path);
+   void Begin(Engine &E);
+   bool Step(Engine &E);
+   void Seek(Engine &E, long Tick);
+   bool Done() const;
+   long Tick() const;
+   long Length() const;
+   long Syncs() const;
+   long Desyncs() const;
+   long FirstDesync() const;
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,166 @@
+// Asteroid Style Game: The rewind buffer, which holds the engine's recent history, so that play can be scrubbed back through.
+// Copyright (c) 2021 Darth Spectra
+#include <string.h>
+#include <utility>
+#include "Rewind.h"
+#include "Snapshot.h"
+#include "Engine.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// class Rewind: private methods
+// ─────────────────────────────
+// The N-th frame held, from the oldest.
+Rewind::FrameT &Rewind::_Frame(size_t N) { return _Frames[(_First + N)%_Frames.size()]; }
+
+// Drop the oldest keyframe, and the deltas that follow on from it.
+void Rewind::_DropGroup() {
+   for (bool Dropped = false; _Count > 0 && !(Dropped && _Frame(0).Key); Dropped = true) {
+      FrameT &F = _Frame(0);
+      (F.Key? _KeyWords: _DeltaWords) -= F.Words;
+      _First = (_First + 1)%_Frames.size(), _Count--;
+   }
+   if (_Count > 0) _Tail = _Frame(0).At; else _Head = 0, _Tail = 0;
+}
+
+// Find room for a frame of Words words in the ring, after the newest one, without running into the oldest, and tell whether there was any.
+bool Rewind::_Place(size_t Words, size_t &At) {
+   size_t Cap = _Ring.size();
+   if (_Count == 0) At = 0;
+   else if (_Head > _Tail) { // The frames lie in [_Tail, _Head): the room is after them, or else before them, at the start of the ring.
+      if (Words <= Cap - _Head) At = _Head;
+      else if (Words <= _Tail) At = 0;
+      else return false;
+   } else if (_Head + Words <= _Tail) At = _Head; // The frames wrap around the end of the ring: the room is between them.
+   else return false;
+   return Words <= Cap;
+}
+
+// Add the Words words at Data as the newest frame, a keyframe if Key, making room by dropping the oldest keyframes and their deltas;
+// a delta is not added, and false is returned, if that would drop the keyframe that it follows on from.
+bool Rewind::_Add(const uint64_t *Data, size_t Words, bool Key) {
+   if (Words > _Ring.size()) { // It would never fit: forget the history.
+      _First = 0, _Count = 0, _Head = 0, _Tail = 0, _KeyWords = 0, _DeltaWords = 0;
+      return Key;
+   }
+   if (_Count == _Frames.size()) _DropGroup();
+   size_t At;
+   while (!_Place(Words, At)) _DropGroup();
+   if (_Count == 0 && !Key) return false;
+   memcpy(_Ring.data() + At, Data, Words*sizeof(uint64_t));
+   if (_Count == 0) _Tail = At;
+   _Head = At + Words;
+   FrameT &F = _Frame(_Count++); F.At = At, F.Words = Words, F.Tick = _Tick, F.Key = Key;
+   (Key? _KeyWords: _DeltaWords) += Words;
+   return true;
+}
+
+// Predict the snapshot of the next tick from the Words-word snapshot at From, into To: the same, with every object and particle moved on by its velocity,
+// each particle spun on by its twist, and the clock moved on, if the game is active.
+void Rewind::_Predict(const uint64_t *From, size_t Words, vector<uint64_t> &To) {
+   if (To.size() < Words) To.resize(Words);
+   memcpy(To.data(), From, Words*sizeof(uint64_t));
+   SnapHeadT H; memcpy(&H, From, sizeof H);
+   SnapLayout L(H.Objs, H.Handles, H.Sparks);
+   char *B = reinterpret_cast<char *>(To.data());
+// Add the Ns doubles at B + By to those at B + Xs.
+   auto Push = [B](size_t Xs, size_t By, size_t Ns) {
+      for (size_t n = 0; n < Ns; n++) {
+         double X, DX; memcpy(&X, B + Xs + n*sizeof X, sizeof X), memcpy(&DX, B + By + n*sizeof DX, sizeof DX);
+         X += DX, memcpy(B + Xs + n*sizeof X, &X, sizeof X);
+      }
+   };
+   Push(L.X, L.DX, H.Objs), Push(L.Y, L.DY, H.Objs);
+   Push(L.SparkX, L.SparkDX, H.Sparks), Push(L.SparkY, L.SparkDY, H.Sparks), Push(L.SparkAngle, L.SparkTwist, H.Sparks);
+   if (H.Active) H.Ticks++, memcpy(B, &H, sizeof H);
+}
+
+// Code the Words-word snapshot at Cur as a delta from the prediction Pred (of PredWords words), into _Enc, and return its size, in words:
+// the snapshot's size, then a bitmap of the words that differ from their predictions (past its end, they are predicted as 0),
+// and then those words, XORed with their predictions, in order.
+// It is branch-free, word by word, since which words differ is all but random.
+size_t Rewind::_Encode(const uint64_t *Cur, size_t Words, const uint64_t *Pred, size_t PredWords) {
+   size_t Maps = (Words + 63)/64;
+   if (_Enc.size() < 1 + Maps + Words) _Enc.resize(1 + Maps + Words);
+   uint64_t *Enc = _Enc.data(), *Map = Enc + 1; size_t N = 1 + Maps, Both = Words < PredWords? Words: PredWords;
+   Enc[0] = Words;
+   for (size_t M = 0; M < Maps; M++) {
+      uint64_t Bits = 0; size_t n0 = 64*M, n1 = n0 + 64 < Words? n0 + 64: Words;
+      for (size_t n = n0; n < n1; n++) {
+         uint64_t D = Cur[n]^(n < Both? Pred[n]: 0);
+         Bits |= (uint64_t)(D != 0) << (n - n0), Enc[N] = D, N += D != 0;
+      }
+      Map[M] = Bits;
+   }
+   return N;
+}
+
+// Decode the delta at Enc from the prediction Pred (of PredWords words) into To, and return the size of the snapshot, in words.
+size_t Rewind::_Decode(const uint64_t *Enc, const uint64_t *Pred, size_t PredWords, vector<uint64_t> &To) {
+   size_t Words = Enc[0], Maps = (Words + 63)/64, N = 1 + Maps;
+   const uint64_t *Map = Enc + 1;
+   if (To.size() < Words) To.resize(Words);
+   for (size_t n = 0; n < Words; n++) {
+      uint64_t P = n < PredWords? Pred[n]: 0;
+      To[n] = (Map[n/64] >> n%64&1) != 0? P^Enc[N++]: P;
+   }
+   return Words;
+}
+
+// class Rewind: public methods
+// ────────────────────────────
+// Make a new, empty, Rewind object, to hold up to Seconds seconds of history, with a keyframe every KeyTicks ticks, in Bytes bytes.
+Rewind::Rewind(int Seconds/* = RewindSeconds*/, int KeyTicks/* = RewindKeyTicks*/, size_t Bytes/* = RewindBytes*/):
+   _Ring(Bytes/sizeof(uint64_t)), _Frames((size_t)(Seconds > 0? Seconds: 1)*TickRate + (KeyTicks > 1? KeyTicks: 1))
+{
+   _KeyTicks = KeyTicks < 1? 1: KeyTicks;
+   Clear();
+}
+
+// Forget the history.
+void Rewind::Clear() {
+   _Head = 0, _Tail = 0, _First = 0, _Count = 0, _Tick = 0, _KeyWords = 0, _DeltaWords = 0, _PrevWords = 0;
+}
+
+// Note the engine's state, as it is after a tick.
+void Rewind::Note(const Engine &E) {
+   size_t Words = E.SaveSize()/sizeof(uint64_t);
+   if (_Cur.size() < Words) _Cur.resize(Words);
+   E.Save(_Cur.data(), Words*sizeof(uint64_t));
+   bool Key = _Count == 0 || _Tick%_KeyTicks == 0;
+   if (!Key) {
+      _Predict(_Prev.data(), _PrevWords, _Pred);
+      Key = !_Add(_Enc.data(), _Encode(_Cur.data(), Words, _Pred.data(), _PrevWords), false);
+   }
+   if (Key) _Add(_Cur.data(), Words, true);
+   swap(_Prev, _Cur), _PrevWords = Words, _Tick++;
+}
+
+// Put the engine E back by Ticks ticks, or as far as the history goes, and tell whether it went back at all.
+// The ticks after it are forgotten, and the history carries on from there.
+bool Rewind::Back(Engine &E, long Ticks) {
+   if (_Count < 2 || Ticks <= 0) return false;
+   size_t To = (size_t)Ticks >= _Count - 1? 0: _Count - 1 - (size_t)Ticks, K = To;
+   while (K > 0 && !_Frame(K).Key) K--;
+// Rebuild the tick from its keyframe, delta by delta, in _Prev.
+   const FrameT &Key = _Frame(K);
+   if (_Prev.size() < Key.Words) _Prev.resize(Key.Words);
+   memcpy(_Prev.data(), _Ring.data() + Key.At, Key.Words*sizeof(uint64_t)), _PrevWords = Key.Words;
+   for (size_t n = K + 1; n <= To; n++)
+      _Predict(_Prev.data(), _PrevWords, _Pred), _PrevWords = _Decode(_Ring.data() + _Frame(n).At, _Pred.data(), _PrevWords, _Prev);
+   if (!E.Restore(_Prev.data(), _PrevWords*sizeof(uint64_t))) { Clear(); return false; }
+// Forget the ticks after it.
+   for (size_t n = To + 1; n < _Count; n++) (_Frame(n).Key? _KeyWords: _DeltaWords) -= _Frame(n).Words;
+   _Count = To + 1, _Head = _Frame(To).At + _Frame(To).Words, _Tick = _Frame(To).Tick + 1;
+   return true;
+}
+
+// The number of ticks that the engine can be put back by.
+long Rewind::Depth() const { return _Count > 0? (long)_Count - 1: 0; }
+
+// The memory used by the history, in all, by its keyframes and by its deltas, and the most it may use, in bytes.
+size_t Rewind::Bytes() const { return (_KeyWords + _DeltaWords)*sizeof(uint64_t); }
+size_t Rewind::KeyBytes() const { return _KeyWords*sizeof(uint64_t); }
+size_t Rewind::DeltaBytes() const { return _DeltaWords*sizeof(uint64_t); }
+size_t Rewind::Capacity() const { return _Ring.size()*sizeof(uint64_t); }
@@ -0,0 +1,60 @@
+#ifndef OnceOnlyRewind_h
+#define OnceOnlyRewind_h
+
+// Asteroid Style Game: The rewind buffer, which holds the engine's recent history, so that play can be scrubbed back through.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Asteroid {
+class Engine;
+
+// The default depth of the history, in seconds of the engine clock, the keyframe spacing, in ticks, and the memory set aside for it, in bytes.
+const int RewindSeconds = 10, RewindKeyTicks = 22;
+const size_t RewindBytes = 4 << 20;
+
+// The rewind buffer
+// ─────────────────
+// After each tick, the engine's state is noted as a snapshot (Snapshot.h): in full, as a keyframe, every KeyTicks ticks,
+// and otherwise as a delta from the tick before, so that any tick held can be rebuilt from the keyframe before it, delta by delta.
+// A delta is taken against a prediction of the tick from the one before, with every object and particle moved on by its velocity,
+// so the objects that coast along, which is most of them, leave nothing in it; it holds a bitmap of the 8-byte words of the snapshot that differ
+// from the prediction, and those words, XORed with it, which is mostly the random number generator, the objects' ages and whatever turned or collided.
+// The keyframes and deltas are kept in one ring of fixed size, set up front, with the last Seconds seconds' worth, if it fits, and up to a keyframe's more,
+// and the oldest keyframe is dropped, along with its deltas, to make room; so the memory used is bounded, and nothing is taken from the heap,
+// once the working buffers have grown to fit the biggest snapshot.
+// Going back puts the engine into the state of an earlier tick, and forgets the ticks after it, from which play carries on anew.
+class Rewind {
+private:
+   struct FrameT { size_t At, Words; long Tick; bool Key; };
+   std::vector<uint64_t> _Ring; // The keyframes and deltas.
+   size_t _Head, _Tail; // Where the next frame goes in the ring, and where the oldest starts.
+   std::vector<FrameT> _Frames; // The frames held, as a ring of _Count from _First.
+   size_t _First, _Count;
+   long _Tick; // The number of ticks noted.
+   int _KeyTicks;
+   size_t _KeyWords, _DeltaWords; // The size of the keyframes and deltas held.
+   std::vector<uint64_t> _Prev, _Cur, _Pred, _Enc; // The working buffers: the last tick noted, this tick, its prediction and its delta.
+   size_t _PrevWords;
+   FrameT &_Frame(size_t N);
+   void _DropGroup();
+   bool _Place(size_t Words, size_t &At);
+   bool _Add(const uint64_t *Data, size_t Words, bool Key);
+   static void _Predict(const uint64_t *From, size_t Words, std::vector<uint64_t> &To);
+   size_t _Encode(const uint64_t *Cur, size_t Words, const uint64_t *Pred, size_t PredWords);
+   static size_t _Decode(const uint64_t *Enc, const uint64_t *Pred, size_t PredWords, std::vector<uint64_t> &To);
+public:
+   Rewind(int Seconds = RewindSeconds, int KeyTicks = RewindKeyTicks, size_t Bytes = RewindBytes);
+   void Clear();
+   void Note(const Engine &E);
+   bool Back(Engine &E, long Ticks);
+   long Depth() const;
+   size_t Bytes() const;
+   size_t KeyBytes() const;
+   size_t DeltaBytes() const;
+   size_t Capacity() const;
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
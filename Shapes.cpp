@@ -0,0 +1,99 @@
+// Asteroid Style Game: The shape library, shared by all the objects.
+// Copyright (c) 2021 Darth Spectra
+#include <math.h>
+#include "Shapes.h"
+#include "Random.h"
+
+using namespace std;
+using namespace Asteroid;
+
+#ifdef M_PI
+static const double TwoPi = 2.0*M_PI; // 2π
+#else
+static const double TwoPi = 6.28318530717958648;
+#endif
+
+// The fixed shapes
+// ────────────────
+static constexpr ObjPos ShipPts[] = {
+   ObjPos(0.0, -10.0), ObjPos(7.0, 10.0), ObjPos(0.0, 7.0), ObjPos(-7.0, 10.0), ObjPos(0.0, -10.0)
+};
+
+static constexpr ObjPos AlienPts[] = {
+   ObjPos(5.0, -5.0), ObjPos(10.0, -2.0), ObjPos(10.0, 2.0), ObjPos(8.0, 4.0),
+   ObjPos(-2.0, 4.0), ObjPos(-2.0, 2.0), ObjPos(2.0, 2.0), ObjPos(2.0, 4.0),
+   ObjPos(-8.0, 4.0), ObjPos(-10.0, 2.0), ObjPos(-10.0, -2.0), ObjPos(10.0, -2.0),
+   ObjPos(10.0, 2.0), ObjPos(-10.0, 2.0), ObjPos(-10.0, -2.0), ObjPos(-5.0, -5.0),
+   ObjPos(0.0, -5.0), ObjPos(-7.0, -2.0), ObjPos(-5.0, -5.0), ObjPos(5.0, -5.0)
+};
+
+static constexpr ObjPos LancePts[] = { ObjPos(0.0, -2.0), ObjPos(0.0, 2.0) };
+
+static constexpr ObjPos ThrustPts[] = { ObjPos(0.0, +1.0), ObjPos(0.0, -1.0) };
+
+// The debris, before it is rumpled: the last point closes the outline.
+static constexpr ObjPos DebrisPts[] = { ObjPos(0.0, 3.0), ObjPos(3.0, 0.0), ObjPos(-2.0, -3.0) };
+static const int DebrisPoints = sizeof DebrisPts/sizeof DebrisPts[0] + 1;
+
+// The rocks: each is a circle of radius 20, sized up/down for its class, with RockPoints - 1 points and a last point to close the outline.
+static const int RockPoints = MaxPoints;
+static const double RockScale[3] = { 1.0, 0.71, 0.4 }; // Boulder, Stone, Pebble.
+
+// The seed for the banks of variants.
+static const uint64_t ShapeSeed = 2021;
+
+// The (mean) radius of a shape.
+static double SizeUp(const ObjPos *Point, int Points) {
+   double R = 0.0;
+   for (int n = 0; n < Points; n++) R += abs(Point[n])/Points;
+   return R;
+}
+
+// The library, which is made once, on first use.
+// ──────────────────────────────────────────────
+struct Library {
+   ObjPos Rocks[3*RockVariants][RockPoints];
+   ObjPos Debris[DebrisVariants][DebrisPoints];
+   Shape Shapes[ShapeN];
+   Library();
+   void Fixed(ShapeT Id, const ObjPos *Point, int Points) {
+      Shapes[Id].Points = Points, Shapes[Id].Point = Point, Shapes[Id].Radius = SizeUp(Point, Points);
+   }
+};
+
+Library::Library() {
+   Random Rand(ShapeSeed);
+   Shapes[NoSH].Points = 0, Shapes[NoSH].Point = nullptr, Shapes[NoSH].Radius = 0.0;
+   Fixed(ShipSH, ShipPts, sizeof ShipPts/sizeof ShipPts[0]);
+   Fixed(AlienSH, AlienPts, sizeof AlienPts/sizeof AlienPts[0]);
+   Fixed(LanceSH, LancePts, sizeof LancePts/sizeof LancePts[0]);
+   Fixed(ThrustSH, ThrustPts, sizeof ThrustPts/sizeof ThrustPts[0]);
+// Rumple the rocks.
+   const double RockVf = 0.25;
+   for (int r = 0; r < 3*RockVariants; r++) {
+      ObjPos *Point = Rocks[r]; double Scale = RockScale[r/RockVariants], Alpha = 0.0;
+      double R[2*(RockPoints - 1)]; Rand.Fill(R, 2*(RockPoints - 1));
+      for (int n = 0; n < RockPoints - 1; n++)
+         Point[n] = ObjPos(20.0*sin(Alpha), 20.0*cos(Alpha)),
+         Alpha += TwoPi/(RockPoints - 1),
+         Point[n] *= Scale,
+         Point[n] += ObjPos(RockVf*Point[n].real()*(2.0*R[2*n] - 1.0), RockVf*Point[n].imag()*(2.0*R[2*n + 1] - 1.0));
+      Point[RockPoints - 1] = Point[0];
+      Fixed((ShapeT)(BoulderSH + r), Point, RockPoints);
+   }
+// Rumple the debris.
+   const double DebrisVf = 0.2;
+   for (int d = 0; d < DebrisVariants; d++) {
+      ObjPos *Point = Debris[d];
+      double R[2*(DebrisPoints - 1)]; Rand.Fill(R, 2*(DebrisPoints - 1));
+      for (int n = 0; n < DebrisPoints - 1; n++)
+         Point[n] = DebrisPts[n] + ObjPos(DebrisVf*DebrisPts[n].real()*(2.0*R[2*n] - 1.0), DebrisVf*DebrisPts[n].imag()*(2.0*R[2*n + 1] - 1.0));
+      Point[DebrisPoints - 1] = Point[0];
+      Fixed((ShapeT)(DebrisSH + d), Point, DebrisPoints);
+   }
+}
+
+const Shape *Asteroid::ShapeTable() {
+   static const Library Lib;
+   return Lib.Shapes;
+}
@@ -0,0 +1,37 @@
+#ifndef OnceOnlyShapes_h
+#define OnceOnlyShapes_h
+
+// Asteroid Style Game: The shape library, shared by all the objects.
+// Copyright (c) 2021 Darth Spectra
+#include "Objects.h"
+
+namespace Asteroid {
+// The number of pre-sculpted variants in each bank of rocks, and in the bank of debris.
+const int RockVariants = 16, DebrisVariants = 16;
+
+// Shape IDs: the fixed shapes, then the banks of rock variants for each size class, then the bank of debris variants.
+// Label has no shape (NoSH), and Spark uses the debris shapes.
+enum ShapeT: int {
+   NoSH = 0, ShipSH, AlienSH, LanceSH, ThrustSH,
+   BoulderSH, StoneSH = BoulderSH + RockVariants, PebbleSH = StoneSH + RockVariants,
+   DebrisSH = PebbleSH + RockVariants, ShapeN = DebrisSH + DebrisVariants
+};
+
+// The shape library
+// ─────────────────
+// A shape is a model: the points of its outline, in the object's own frame, and its mean radius, which is used as the collision radius.
+// Objects hold only the ID of their shape and the transform that places it (their position and angle), never the points themselves.
+// The fixed shapes are constant tables; the rocks and debris are each given one of a bank of variants,
+// which are sculpted once, on first use, from a fixed seed, so every run of the game has the same banks.
+struct Shape {
+   int Points;
+   const ObjPos *Point;
+   double Radius;
+};
+
+// The shape table, indexed by shape ID.
+const Shape *ShapeTable();
+inline const Shape &ShapeOf(ShapeT Id) { return ShapeTable()[Id]; }
+} // end of namespace Asteroid
+
+#endif // OnceOnly
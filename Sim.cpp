@@ -0,0 +1,221 @@
+// Asteroid Style Game: The simulation thread, which runs the engine on its own, for the game to draw from.
+// Copyright (c) 2021 Darth Spectra
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include "Sim.h"
+#include "Trace.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// struct SceneT: public methods
+// ─────────────────────────────
+// Make a new, empty, SceneT object, with room set aside for a busy game.
+SceneT::SceneT():
+   Outlined(0), Seq(0), Steps(0), Stamp(0), Period(0), Ticks(0), Xs(0), Ys(0), Score(0), Lives(0), HiScore(0), ExScore(0), Charge(0),
+   Active(false), InGame(false), EndGame(true), Replaying(false), Done(false), Rewinding(false), ThrustSnd(false)
+{
+   Lines.reserve(16*(MaxObjs + MaxParticles)), Shifts.reserve(16*(MaxObjs + MaxParticles)), Captions.reserve(16);
+   for (int T = 0; T < TypeN; T++) Census[T] = 0;
+}
+
+// Take the engine's state, as it is to be drawn: the outlines of its objects, their captions, its particles, the scores, the thrust sound and the profile;
+// along with how far each moved since the snapshot before: the objects, from where Places holds that they were then, by their handles,
+// which is brought up to date, and the particles, which never change their course, by their velocity, over the Ran ticks run since.
+// Anything new since then, or that wrapped around the play area, is taken not to have moved.
+void SceneT::Take(const Engine &E, vector<PlaceT> &Places, long Ran) {
+   Lines.clear(), Shifts.clear(), Captions.clear();
+   E.GetPlayDims(&Xs, &Ys);
+   double HalfX = Xs/2.0, HalfY = Ys/2.0;
+   auto Moved = [HalfX, HalfY](const ObjPos &D) { return fabs(D.real()) < HalfX && fabs(D.imag()) < HalfY? D: ObjPos(); };
+   for (size_t Ox = 0; Ox < E.ObjN(); Ox++) {
+      const Thing *Obj = E.ObjAtN(Ox); if (Obj->GetDead()) continue;
+      Handle H = Obj->GetHandle(); ObjPos Pos = Obj->GetPos(), Shift;
+      if ((size_t)H.Ix >= Places.size()) Places.resize(H.Ix + 1, PlaceT{ ObjPos(), 0 });
+      PlaceT &Was = Places[H.Ix];
+      if (Was.Gen == H.Gen) Shift = Moved(Pos - Was.Pos);
+      Was.Pos = Pos, Was.Gen = H.Gen;
+      int N = Obj->GetPoints();
+      if (N > 0) {
+         ObjPos P0 = Obj->PosPoints(0);
+         for (int n = 1; n < N; n++) {
+            ObjPos P1 = Obj->PosPoints(n);
+            Lines.push_back(P0), Lines.push_back(P1), Shifts.push_back(Shift), Shifts.push_back(Shift), P0 = P1;
+         }
+      }
+      const char *Caption = Obj->GetCaption();
+      if (*Caption != '\0') {
+         CaptionT C; C.Pos = Pos, C.Shift = Shift, C.Pts = Obj->GetPts(), strncpy(C.Text, Caption, MaxCaption), C.Text[MaxCaption - 1] = '\0';
+         Captions.push_back(C);
+      }
+   }
+   Outlined = Lines.size();
+   E.GetParticles().Lines([this, Ran, &Moved](const ObjPos &P0, const ObjPos &P1, const ObjPos &Dir) {
+      ObjPos Shift = Moved((double)Ran*Dir);
+      Lines.push_back(P0), Lines.push_back(P1), Shifts.push_back(Shift), Shifts.push_back(Shift);
+   });
+   Ticks = E.GetTicks();
+   Score = E.GetScore(), Lives = E.GetLives(), HiScore = E.GetHiScore(), ExScore = E.GetExScore(), Charge = E.Charge();
+   for (int T = 0; T < TypeN; T++) Census[T] = E.Census((TypeT)T);
+#ifdef PROFILE
+   Prof.Take(Profiler());
+#endif
+   Active = E.GetActive(), InGame = E.InGame(), EndGame = E.EndGame(), ThrustSnd = E.GetThrustSnd();
+}
+
+// class Sim: private methods
+// ──────────────────────────
+// Take in the order O.
+void Sim::_Take(const OrderRecT &O) {
+   _Taken = O.Seq;
+   switch (O.Order) {
+      case SpinOR: _Machine.SetSpin(O.A); break;
+      case PushOR: _Machine.SetPushing(O.A != 0); break;
+      case FireOR: _Machine.Fire(); break;
+      case ReLoadOR: _Machine.ReLoad(); break;
+      case AlienOR: _Machine.AddAlienCheat(); break;
+   // A new game, or demo, or the end of one, starts the rewind buffer over; ending one also ends the replay.
+      case BegGameOR: _Pausing = false, _Rewinding = false, _Rewind.Clear(), _Machine.BegGame(O.A); break;
+      case BegDemoOR: _Rewinding = false, _Rewind.Clear(), _Machine.BegDemo(O.A, O.B); break;
+      case StopOR: _Pausing = false, _Replaying = false, _Rewinding = false, _Rewind.Clear(), _Machine.Stop(); break;
+      case PauseOR: _Pausing = O.A != 0; break;
+      case TurboOR: _Turbo = O.A < 1? 1: O.A; break;
+      case PeriodOR: _Period = O.A < 0? 0: O.A; break;
+   // A replay, or a game being recorded, cannot be rewound, since the replay could not follow the engine back.
+      case RewindOR: _Rewinding = O.A != 0 && !_Replaying && !_Rec.On() && _Machine.GetActive(); break;
+      case LevelOR: _Machine.SetLevel(O.X); break;
+      case HiScoreOR: _Machine.SetHiScore(O.A); break;
+   // A replay keeps the play area that it was recorded with.
+      case DimsOR: if (!_Replaying) _Machine.SetPlayDims(O.A, O.B); break;
+      default: break;
+   }
+}
+
+// Run the engine on by a step: by the turbo count of ticks, if it is not paused, nor at the end of the game, nor of the tick limit;
+// and tell whether it ran at all.
+// A replay runs through its games, and the pauses between them, on its own, tick by tick, just as they were recorded,
+// and rewinding goes back through the ticks noted, tick by tick, as far as they go, without telling of any events.
+bool Sim::_Step() {
+   int Ran = 0;
+   for (; Ran < _Turbo && !_Pausing && _Limit != 0; Ran++) {
+      if (_Replaying) {
+         if (!_Play.Step(_Machine)) break;
+      } else if (_Rewinding) {
+         if (!_Rewind.Back(_Machine, 1)) break;
+      } else {
+         if (_Machine.EndGame()) break;
+         _Machine.Tick();
+         if (!_Rec.On()) _Rewind.Note(_Machine);
+      }
+      _Steps++; if (_Limit > 0) _Limit--;
+   }
+   return Ran > 0;
+}
+
+// Make a render snapshot, stamped with the time, and publish it; if the one published before it was never taken by the game, it is simply dropped.
+// The particles are taken to have moved back, rather than on, while rewinding.
+void Sim::_Publish() {
+   SceneT &S = _Scenes.Back();
+   S.Take(_Machine, _Places, _Rewinding? _Shown - _Steps: _Steps - _Shown), _Shown = _Steps;
+   S.Seq = _Taken, S.Steps = _Steps, S.Replaying = _Replaying, S.Done = _Replaying && _Play.Done(), S.Rewinding = _Rewinding;
+   S.Stamp = Now(), S.Period = 1000*(int64_t)_Period;
+   _Published++, _Scenes.Publish();
+}
+
+// The simulation thread: take in the orders, then run the steps due, by the time owed, and publish, until stopped, or until the tick limit is reached.
+// It wakes up once a period, and runs up to SimCatchUp steps, if it has fallen behind; any more time lost than that is given up,
+// rather than made up in a rush. It publishes only when a step has come due, so that each snapshot is a step on from the one before.
+// Run freely, it steps as fast as it can, publishing after every step, and only gives up the processor when there is nothing to do.
+void Sim::_Run() {
+   Trace::NameThread("sim");
+   typedef chrono::steady_clock Clock;
+   Clock::time_point Last = Clock::now(); Clock::duration Owed(0);
+   while (_Running.load(memory_order_acquire)) {
+      OrderRecT O; while (_Orders.Pop(O)) _Take(O);
+      Clock::time_point Now = Clock::now();
+      if (_Period > 0) {
+         chrono::microseconds Period(_Period);
+         Owed += Now - Last, Last = Now;
+         int Steps = 0;
+         for (; Owed >= Period && Steps < SimCatchUp && _Limit != 0; Owed -= Period, Steps++) _Step();
+         if (Owed >= Period) Owed %= Period;
+         if (Steps > 0) _Publish();
+         if (_Limit == 0) break;
+         this_thread::sleep_until(Now + (Period - Owed));
+      } else {
+         Last = Now, Owed = Clock::duration(0);
+         bool Ran = _Step();
+         _Publish();
+         if (_Limit == 0) break;
+         if (!Ran) this_thread::yield();
+      }
+   }
+   _Running.store(false, memory_order_release);
+}
+
+// class Sim: public methods
+// ─────────────────────────
+// Make a new Sim object, with an idle engine telling its events to the event stream, and the thread not yet started.
+Sim::Sim(): _Running(false), _Sent(0), _Taken(0), _Steps(0), _Limit(-1), _Published(0), _Shown(0), _Period(0), _Turbo(1) {
+   _Pausing = false, _Replaying = false, _Rewinding = false;
+   _Places.reserve(MaxObjs), _Machine.SetEvents(&_Events);
+}
+
+// Stop the thread, if it is running, and free the Sim object.
+Sim::~Sim() { Stop(); }
+
+// The engine: to be set up before the thread is started, or looked at after it has stopped, but not touched while it runs.
+Engine &Sim::GetEngine() { return _Machine; }
+
+// The engine's event stream: its listeners are to be attached before the thread is started, and each drained on its own thread, as often as it likes.
+Events &Sim::GetEvents() { return _Events; }
+
+// Load the replay in the file at Path, to be played in place of the game, and tell whether it could be (before the thread is started).
+bool Sim::Play(const char *Path) {
+   if (!_Play.Load(Path)) return false;
+   _Play.Begin(_Machine), _Replaying = true;
+   return true;
+}
+
+// Record the engine's inputs into a replay in the file at Path, and tell whether it could be opened (before the thread is started).
+bool Sim::Record(const char *Path) { return _Rec.Start(_Machine, Path); }
+
+// The number of render snapshots published (after the thread has stopped).
+long Sim::Published() const { return _Published; }
+
+// Start the thread, stepping once every PeriodUs microseconds, or as fast as it can, if PeriodUs is 0; and stopping, if Limit ≥ 0, after Limit ticks.
+// A first render snapshot is published at once, so that the game has one to draw from straight away.
+void Sim::Start(int PeriodUs, long Limit/* = -1*/) {
+   Stop();
+   _Period = PeriodUs < 0? 0: PeriodUs, _Limit = Limit;
+   _Publish();
+   _Running.store(true, memory_order_release), _Thread = thread(&Sim::_Run, this);
+}
+
+// Stop the thread, and wait for it to finish its step.
+void Sim::Stop() {
+   _Running.store(false, memory_order_release);
+   if (_Thread.joinable()) _Thread.join();
+}
+
+// Is the thread running? It stops by itself when it reaches its tick limit.
+bool Sim::Running() const { return _Running.load(memory_order_acquire); }
+
+// The steady clock, in nanoseconds, which the render snapshots are stamped by.
+int64_t Sim::Now() { return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(); }
+
+// Send the order Order, with its arguments, to the simulation thread (from the game's thread only), and return its number.
+// While the thread is not running, the order is taken in at once.
+long Sim::Send(OrderT Order, int A/* = 0*/, int B/* = 0*/, double X/* = 0.0*/) {
+   OrderRecT O = { Order, A, B, X, ++_Sent };
+   if (!Running()) _Take(O);
+   else while (!_Orders.Push(O)) this_thread::yield();
+   return O.Seq;
+}
+
+// Take the latest render snapshot, if there is a newer one than that held, and tell whether there was (on the game's thread only).
+bool Sim::Fetch() { return _Scenes.Fetch(); }
+
+// The render snapshot held (on the game's thread only); it is left unchanged until the next Fetch().
+const SceneT &Sim::Scene() const { return _Scenes.Front(); }
@@ -0,0 +1,122 @@
+#ifndef OnceOnlySim_h
+#define OnceOnlySim_h
+
+// Asteroid Style Game: The simulation thread, which runs the engine on its own, for the game to draw from.
+// Copyright (c) 2021 Darth Spectra
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Engine.h"
+#include "Events.h"
+#include "Profile.h"
+#include "Queue.h"
+#include "Replay.h"
+#include "Rewind.h"
+#include "Triple.h"
+
+namespace Asteroid {
+// The orders that the game sends to the simulation thread: the ship controls, the game's state changes and the settings.
+enum OrderT {
+   NoOR = 0, SpinOR, PushOR, FireOR, ReLoadOR, AlienOR, BegGameOR, BegDemoOR, StopOR, PauseOR, TurboOR, PeriodOR, RewindOR, LevelOR, HiScoreOR, DimsOR,
+   OrderN
+};
+
+// The number of orders that may be waiting for the simulation thread at once; the game waits for room, if ever there are more.
+const size_t SimOrders = 256;
+
+// The most steps that the simulation thread runs at once, to catch up on time lost; any more time than that is given up.
+const int SimCatchUp = 4;
+
+// An order, with its arguments, and its number, counted from 1, in the order that they were sent.
+struct OrderRecT { OrderT Order; int A, B; double X; long Seq; };
+
+// A caption, as it is to be drawn: centered at Pos, in the font Pts, having moved by Shift over the last step.
+struct CaptionT { ObjPos Pos, Shift; FontT Pts; char Text[MaxCaption]; };
+
+// Where an object was, by its handle's index, when the last render snapshot was made, and the generation of the handle.
+struct PlaceT { ObjPos Pos; unsigned Gen; };
+
+// The render snapshot
+// ───────────────────
+// Everything that the game draws, or sounds, for one step of the simulation thread, taken from the engine after its ticks,
+// so that the game never touches the engine itself, and the snapshot never changes while the game holds it.
+// The objects' outlines and the particles are all laid out as line segments, in pairs of end points, in the engine's coordinates, in one buffer,
+// so that the game may transform them all in one pass, and draw them with one call.
+// Each end point and caption also carries how far it moved since the snapshot before, so that the game may draw it part way between the two,
+// by how far it is into the next step (by the snapshot's stamp and the step period), and paint more often than the engine steps, without the motion stuttering.
+// The engine's profile is taken into it as well, so that the game never reads the simulation thread's profiler.
+// Of the sounds, only the thrust, which is a state, is held here; the others are events, which are told by the event stream, so that none are missed.
+struct SceneT {
+   std::vector<ObjPos> Lines; // The line segments of the objects' outlines, then of the particles.
+   std::vector<ObjPos> Shifts; // How far each end point moved since the snapshot before.
+   size_t Outlined; // The number of end points in the objects' outlines, which come first.
+   std::vector<CaptionT> Captions;
+   long Seq; // The number of the latest order taken in before the snapshot.
+   long Steps; // The number of ticks run by the simulation thread.
+   int64_t Stamp, Period; // When the snapshot was made, by Sim::Now(), and the step period, in nanoseconds, or 0 when run freely.
+   int Ticks, Xs, Ys, Score, Lives, HiScore, ExScore, Charge;
+   int Census[TypeN];
+   PercentilesT Prof; // The percentiles of the engine's probes, from the simulation thread's profiler (only when PROFILE is defined).
+   bool Active, InGame, EndGame, Replaying, Done, Rewinding;
+   bool ThrustSnd;
+   SceneT();
+   void Take(const Engine &E, std::vector<PlaceT> &Places, long Ran);
+};
+
+// The simulation thread
+// ─────────────────────
+// The engine runs on a thread of its own, stepping by a fixed period, and the game draws from the latest render snapshot that it has made,
+// so a slow paint never holds up the simulation, nor a slow tick the paint.
+// The steps are timed by the steady clock: the time since the last wake-up is added to the time owed, and as many whole steps are run as it covers,
+// up to SimCatchUp, which may be none, if the thread woke early; the rest is carried over, so timer jitter never changes the speed of the game.
+// The thread owns the engine, along with the replay recorder and player and the rewind buffer: once it is started, nothing else touches them.
+// Each step, it takes in the orders that have been sent (Send()), through a lock-free queue, then runs the engine on by the turbo count of ticks,
+// unless it is paused or the game has ended; or plays the replay on, or rewinds; then makes a render snapshot, and publishes it through a triple buffer.
+// The game takes the latest one (Fetch()), whenever it likes, and holds it, unchanged, until it takes another.
+// The engine's events (Events.h) are passed on through its event stream, which the game's listeners drain, each at its own pace (GetEvents()).
+// The orders are numbered, and each snapshot carries the number of the latest one taken in before it,
+// so that the game can tell whether a snapshot reflects a state change that it has ordered.
+class Sim {
+private:
+   Engine _Machine;
+   Recorder _Rec;
+   Player _Play;
+   Rewind _Rewind;
+   Events _Events;
+   Queue<OrderRecT, SimOrders> _Orders;
+   Triple<SceneT> _Scenes;
+   std::thread _Thread;
+   std::atomic<bool> _Running;
+   long _Sent; // The game's.
+// The simulation thread's.
+   long _Taken, _Steps, _Limit, _Published, _Shown; // _Shown: the ticks run when the last snapshot was made.
+   std::vector<PlaceT> _Places;
+   int _Period, _Turbo; // The step period, in microseconds, or 0 to run freely, and the engine ticks per step.
+   bool _Pausing, _Replaying, _Rewinding;
+   void _Take(const OrderRecT &O);
+   bool _Step();
+   void _Publish();
+   void _Run();
+public:
+   Sim();
+   ~Sim();
+// Set-up, before the thread is started, and inspection, after it has been stopped.
+   Engine &GetEngine();
+   Events &GetEvents();
+   bool Play(const char *Path);
+   bool Record(const char *Path);
+   long Published() const;
+// The thread.
+   void Start(int PeriodUs, long Limit = -1);
+   void Stop();
+   bool Running() const;
+   static int64_t Now();
+// The game's side.
+   long Send(OrderT Order, int A = 0, int B = 0, double X = 0.0);
+   bool Fetch();
+   const SceneT &Scene() const;
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
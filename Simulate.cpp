@@ -0,0 +1,251 @@
+// Asteroid Style Game: The headless simulation driver.
+// Copyright (c) 2021 Darth Spectra
+// Run the game engine with no window or sound, as fast as the CPU allows, for profiling and soak-testing.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Allocs.h"
+#include "Engine.h"
+#include "Events.h"
+#include "Profile.h"
+#include "Replay.h"
+#include "Rewind.h"
+#include "Sim.h"
+#include "Snapshot.h"
+#include "Trace.h"
+
+using namespace std;
+using namespace Asteroid;
+
+static void Usage(const char *App) {
+   fprintf(stderr,
+      "Usage: %s [-demo | -game] [-ticks N] [-rocks N] [-aliens N] [-level L] [-dims Xs Ys] [-seed N] [-trace File] [-record File | -load File] [-save File] [-rewind S | -thread [-period U]]\n"
+      "       %s -play File [-seek N] [-trace File] [-save File] [-rewind S]\n"
+      "\t-demo\tRun the demo, with the ship flown by the engine (the default).\n"
+      "\t-game\tRun a game, with the ship left idle.\n"
+      "\t-ticks N\tThe number of engine ticks to run (default 100000).\n"
+      "\t-rocks N\tThe number of rocks at the start of each life (default 10).\n"
+      "\t-aliens N\tThe number of aliens to bring in at the start of each game, for stress testing (default 0).\n"
+      "\t-level L\tThe game level, in (0, 1] (default 0.5).\n"
+      "\t-dims Xs Ys\tThe play area (default 535 400).\n"
+      "\t-seed N\tThe random number seed (default 1).\n"
+      "\t-trace File\tWrite a Chrome trace-event file of the engine's ticks and their phases, for chrome://tracing or Perfetto.\n"
+      "\t-record File\tRecord the run's inputs into a replay file.\n"
+      "\t-play File\tPlay a replay file back, as fast as the CPU allows, checking it against the sync points recorded in it.\n"
+      "\t-seek N\tSkip the first N ticks of the replay, and time how long that takes.\n"
+      "\t-load File\tStart from the snapshot in File, rather than from an idle engine.\n"
+      "\t-save File\tSave a snapshot of the engine into File, at the end of the run.\n"
+      "\t-rewind S\tKeep the last S seconds of the engine's history in a rewind buffer, and, at the end, report its size and go back through it.\n"
+      "\t-thread\tRun the engine on the simulation thread, as the game does, with this thread taking its render snapshots as fast as it can.\n"
+      "\t-period U\tStep the simulation thread once every U microseconds, as the game does, rather than as fast as it can (default 0).\n"
+      "The game or demo is restarted, whenever it ends, until all the ticks are run.\n",
+      App, App
+   );
+}
+
+int main(int AC, char **AV) {
+   bool InDemo = true; long Ticks = 100000; int Rocks = 10, Aliens = 0; double Level = 0.5; int Xs = 535, Ys = 400; uint64_t Seed = 1;
+   const char *TraceTo = nullptr, *RecordTo = nullptr, *PlayFrom = nullptr; long SeekTo = 0;
+   const char *LoadFrom = nullptr, *SaveTo = nullptr; int RewindSecs = 0; bool Threaded = false; int PeriodUs = 0;
+   for (int A = 1; A < AC; A++) {
+      const char *Arg = AV[A]; bool More = A + 1 < AC;
+      if (strcmp(Arg, "-demo") == 0) InDemo = true;
+      else if (strcmp(Arg, "-game") == 0) InDemo = false;
+      else if (strcmp(Arg, "-ticks") == 0 && More) Ticks = atol(AV[++A]);
+      else if (strcmp(Arg, "-rocks") == 0 && More) Rocks = atoi(AV[++A]);
+      else if (strcmp(Arg, "-aliens") == 0 && More) Aliens = atoi(AV[++A]);
+      else if (strcmp(Arg, "-level") == 0 && More) Level = atof(AV[++A]);
+      else if (strcmp(Arg, "-dims") == 0 && A + 2 < AC) Xs = atoi(AV[++A]), Ys = atoi(AV[++A]);
+      else if (strcmp(Arg, "-seed") == 0 && More) Seed = strtoull(AV[++A], nullptr, 0);
+      else if (strcmp(Arg, "-trace") == 0 && More) TraceTo = AV[++A];
+      else if (strcmp(Arg, "-record") == 0 && More) RecordTo = AV[++A];
+      else if (strcmp(Arg, "-play") == 0 && More) PlayFrom = AV[++A];
+      else if (strcmp(Arg, "-seek") == 0 && More) SeekTo = atol(AV[++A]);
+      else if (strcmp(Arg, "-load") == 0 && More) LoadFrom = AV[++A];
+      else if (strcmp(Arg, "-save") == 0 && More) SaveTo = AV[++A];
+      else if (strcmp(Arg, "-rewind") == 0 && More) RewindSecs = atoi(AV[++A]);
+      else if (strcmp(Arg, "-thread") == 0) Threaded = true;
+      else if (strcmp(Arg, "-period") == 0 && More) PeriodUs = atoi(AV[++A]);
+      else { Usage(AV[0]); return 1; }
+   }
+// A replay starts from an idle engine, so a snapshot can neither be recorded nor played from.
+   if (LoadFrom != nullptr && (RecordTo != nullptr || PlayFrom != nullptr)) { Usage(AV[0]); return 1; }
+// The simulation thread keeps a rewind buffer of its own, and is only driven as the demo or a game.
+   if (Threaded && (RecordTo != nullptr || PlayFrom != nullptr || RewindSecs > 0)) { Usage(AV[0]); return 1; }
+   Sim Runner; Engine Own; Engine &Machine = Threaded? Runner.GetEngine(): Own;
+// The engine's events are tallied, as telemetry, from its event stream: the simulation thread's own, or else one of our own.
+   Events OwnEvents; Events &Evs = Threaded? Runner.GetEvents(): OwnEvents;
+   if (!Threaded) Own.SetEvents(&OwnEvents);
+   Evs.Attach(TelemetryLI);
+   long Told[EventN] = { 0 };
+   auto Tally = [&Evs, &Told]() { for (EventRecT Ev; Evs.Pop(TelemetryLI, Ev); ) Told[Ev.Event] += Ev.Event == ScoreEV? Ev.N: 1; };
+   Machine.SetSeed(Seed), Machine.SetPlayDims(Xs, Ys), Machine.SetLevel(Level);
+   if (Aliens > MaxAliens) Machine.SetAlienCap(Aliens);
+   long Restarts = 0; double Objs = 0.0, Parts = 0.0; size_t MaxObjs = 0, MaxParts = 0;
+   long TickAllocs = 0, AllocTicks = 0, LastAllocTick = -1;
+   typedef chrono::steady_clock Clock;
+// A replay sets the engine up, and drives it, all by itself; the run then lasts as long as the replay.
+   Player Play; Recorder Rec; Snapshot Snap; uint64_t SeekSum = 0;
+// The rewind buffer, and the checksums of the ticks that it may hold, to check the ticks that it goes back to.
+   Rewind Back(RewindSecs > 0? RewindSecs: 1); vector<uint64_t> Sums(RewindSecs > 0? (size_t)RewindSecs*TickRate + RewindKeyTicks: 0);
+   double NoteSecs = 0.0;
+   if (LoadFrom != nullptr) {
+      if (!Snap.Read(LoadFrom) || !Snap.Give(Machine)) { fprintf(stderr, "Cannot restore the snapshot in %s.\n", LoadFrom); return 1; }
+      printf("restored %s: %zu objects, %zu particles, tick %d\n", LoadFrom, Machine.ObjN(), Machine.ParticleN(), Machine.GetTicks());
+   }
+   if (PlayFrom != nullptr) {
+      if (!Play.Load(PlayFrom)) { fprintf(stderr, "Cannot read the replay in %s.\n", PlayFrom); return 1; }
+      Play.Begin(Machine);
+      if (SeekTo > 0) {
+         Clock::time_point T0 = Clock::now();
+         Play.Seek(Machine, SeekTo), SeekSum = Machine.Checksum();
+         printf("seek to tick %ld: %.3f ms\n", Play.Tick(), 1.0e3*chrono::duration<double>(Clock::now() - T0).count());
+      }
+      Ticks = Play.Length() - Play.Tick();
+   } else if (RecordTo != nullptr && !Rec.Start(Machine, RecordTo)) { fprintf(stderr, "Cannot write the replay to %s.\n", RecordTo); return 1; }
+   int LastTicks = Machine.GetTicks();
+   if (TraceTo != nullptr) {
+      if (!Trace::Start(TraceTo)) { fprintf(stderr, "Cannot write the trace to %s.\n", TraceTo); return 1; }
+      Trace::NameThread("engine");
+   }
+   Clock::time_point T0 = Clock::now();
+// On the simulation thread, the game or demo is restarted, just as it is in the game, once a snapshot shows it to have ended,
+// and the ticks run are the same as they would be here; the objects and particles are counted by the snapshots taken.
+   long Scenes = 0, RunAllocs = Allocs;
+   if (Threaded) {
+      long Seq = 0;
+      Runner.Start(PeriodUs, Ticks);
+      while (Runner.Running()) {
+         if (!Runner.Fetch()) {
+            if (PeriodUs > 0) this_thread::sleep_for(chrono::microseconds(PeriodUs/4)); else this_thread::yield();
+            continue;
+         }
+         const SceneT &S = Runner.Scene(); Scenes++, Tally();
+         size_t N = 0; for (int T = NoOT + 1; T < TypeN; T++) if (!Particulate((TypeT)T)) N += S.Census[T];
+         Objs += N; if (N > MaxObjs) MaxObjs = N;
+         N = (S.Lines.size() - S.Outlined)/2; Parts += N; if (N > MaxParts) MaxParts = N;
+         if (S.EndGame && S.Seq >= Seq && S.Steps < Ticks) {
+            Seq = InDemo? Runner.Send(BegDemoOR, 20, Rocks): Runner.Send(BegGameOR, Rocks);
+            for (int A = 0; A < Aliens; A++) Seq = Runner.Send(AlienOR);
+            if (S.Steps > 0) Restarts++;
+         }
+      }
+      Runner.Stop(), RunAllocs = Allocs - RunAllocs, Tally();
+   }
+   for (long T = 0; T < Ticks && !Threaded; T++) {
+      long Allocs0 = Allocs;
+      if (PlayFrom != nullptr) {
+      // The replay restarts the game by itself; the restarts are told by the engine clock going back.
+         Play.Step(Machine);
+         if (Machine.GetTicks() < LastTicks) Restarts++;
+         LastTicks = Machine.GetTicks();
+      } else {
+         if (Machine.EndGame()) {
+            if (InDemo) Machine.BegDemo(20, Rocks); else Machine.BegGame(Rocks);
+            for (int A = 0; A < Aliens; A++) Machine.AddAlienCheat();
+            if (T > 0) Restarts++;
+         }
+         Allocs0 = Allocs;
+         Machine.Tick();
+      }
+      if (RewindSecs > 0) {
+         Clock::time_point N0 = Clock::now();
+         Back.Note(Machine);
+         NoteSecs += chrono::duration<double>(Clock::now() - N0).count();
+         Sums[T%Sums.size()] = Machine.Checksum();
+      }
+      if (Allocs > Allocs0) TickAllocs += Allocs - Allocs0, AllocTicks++, LastAllocTick = T;
+      Tally();
+      size_t N = Machine.ObjN(); Objs += N; if (N > MaxObjs) MaxObjs = N;
+      N = Machine.ParticleN(); Parts += N; if (N > MaxParts) MaxParts = N;
+   }
+   double Secs = chrono::duration<double>(Clock::now() - T0).count();
+   if (TraceTo != nullptr) {
+      Trace::Stop();
+      long Dropped = Trace::Dropped(); if (Dropped > 0) fprintf(stderr, "%ld trace events were dropped.\n", Dropped);
+   }
+   if (Rec.On()) {
+      Rec.Stop();
+      printf("recorded %ld ticks into %s: %ld bytes\n", Rec.Ticks(), RecordTo, Rec.Bytes());
+   }
+   if (SaveTo != nullptr) {
+      if (!Snap.Take(Machine) || !Snap.Write(SaveTo)) { fprintf(stderr, "Cannot save the snapshot to %s.\n", SaveTo); return 1; }
+      printf("saved %s: %zu objects, %zu bytes\n", SaveTo, Machine.ObjN(), Snap.Size());
+   }
+   printf(
+      "mode %s%s, ticks %ld, seconds %.3f, ticks/sec %.0f\n",
+      PlayFrom != nullptr? "replay": InDemo? "demo": "game", Threaded? " (threaded)": "", Ticks, Secs, Secs > 0.0? Ticks/Secs: 0.0
+   );
+// On the simulation thread, the means are over the snapshots taken, and the particles are counted by their line segments.
+   long Samples = Threaded? Scenes: Ticks;
+   printf("objects: mean %.1f, peak %zu; restarts %ld; hi score %d\n", Samples > 0? Objs/Samples: 0.0, MaxObjs, Restarts, Machine.GetHiScore());
+   printf("%s: mean %.1f, peak %zu\n", Threaded? "particle lines": "particles", Samples > 0? Parts/Samples: 0.0, MaxParts);
+   if (Threaded) printf("snapshots: %ld published, %ld taken; heap allocations in the run: %ld\n", Runner.Published(), Scenes, RunAllocs);
+   printf(
+      "events: booms %ld, lances %ld, deaths %ld, alien kills %ld, extra lives %ld, points %ld; lost %ld\n",
+      Told[BoomEV], Told[LanceEV], Told[DiedEV], Told[AlienEV], Told[ExtraLifeEV], Told[ScoreEV], Evs.Lost(TelemetryLI)
+   );
+// The census of the last game (or demo) run: each type's count at the end, and its peak, for the types that showed up.
+   static const char *const TypeName[TypeN] = {
+      "none", "boulder", "stone", "pebble", "ship", "alien", "lance", "debris", "spark", "thrust", "label"
+   };
+   printf("census of the last game (now/peak):");
+   for (int T = NoOT + 1; T < TypeN; T++)
+      if (Machine.PeakCensus((TypeT)T) > 0) printf(" %s %d/%d", TypeName[T], Machine.Census((TypeT)T), Machine.PeakCensus((TypeT)T));
+   printf("\n");
+#ifdef PROFILE
+// The profile of the latest ticks: the percentiles of each probe, in microseconds (the pairs are counted, not timed).
+// On the simulation thread, the engine's probes are in its own profiler, and are taken from its last render snapshot.
+   PercentilesT Prof;
+   if (!Threaded) Prof.Take(Profiler());
+   else Runner.Fetch(), Prof = Runner.Scene().Prof;
+   printf("profile of the latest %d ticks (p50/p95/p99):", ProfileSamples);
+   for (int P = TickPR; P <= PairsPR; P++) {
+      if (Prof.Samples[P] == 0) continue;
+      double Scale = P == PairsPR? 1.0: 1.0e-3;
+      printf(" %s %.1f/%.1f/%.1f", Profile::Name((ProbeT)P), Scale*Prof.P50[P], Scale*Prof.P95[P], Scale*Prof.P99[P]);
+   }
+   printf("\n");
+#endif
+   if (PlayFrom != nullptr) {
+      printf("replay: syncs %ld, desyncs %ld", Play.Syncs(), Play.Desyncs());
+      if (Play.Desyncs() > 0) printf(", the first at tick %ld", Play.FirstDesync());
+      printf("\n");
+   // Seek back, now that the keyframes are all there, and check that it comes to the same state as the seek ahead did.
+      if (SeekTo > 0) {
+         Clock::time_point T0 = Clock::now();
+         Play.Seek(Machine, SeekTo);
+         double Secs = chrono::duration<double>(Clock::now() - T0).count();
+         printf("seek back to tick %ld: %.3f ms, %s\n", Play.Tick(), 1.0e3*Secs, Machine.Checksum() == SeekSum? "same state": "DIFFERENT STATE");
+      }
+   }
+// Go back by a tick, then by half of what is left, then as far as the history goes, and check each tick against its checksum.
+   if (RewindSecs > 0 && Ticks > 0) {
+      long Depth = Back.Depth();
+      printf(
+         "rewind: %ld ticks (%.1f seconds), %zu bytes (keyframes %zu, deltas %zu), %.0f bytes/second, of %zu; note %.2f us/tick\n",
+         Depth, (double)Depth/TickRate, Back.Bytes(), Back.KeyBytes(), Back.DeltaBytes(),
+         Depth > 0? (double)Back.Bytes()*TickRate/Depth: 0.0, Back.Capacity(), 1.0e6*NoteSecs/Ticks
+      );
+      long At = Ticks - 1;
+      const long Steps[] = { 1, Depth/2, Depth };
+      for (long By: Steps) {
+         long Went = By < Back.Depth()? By: Back.Depth();
+         Clock::time_point T0 = Clock::now();
+         if (!Back.Back(Machine, By)) continue;
+         double Secs = chrono::duration<double>(Clock::now() - T0).count();
+         At -= Went;
+         printf("rewind back %ld ticks: %.3f ms, %s\n", Went, 1.0e3*Secs, Machine.Checksum() == Sums[At%Sums.size()]? "same state": "DIFFERENT STATE");
+      }
+   }
+// A replay's ticks include the player's, which takes a keyframe every SyncTicks ticks, and the rewind buffer's, whose buffers grow to fit.
+   if (!Threaded) printf(
+      "heap allocations in ticks%s%s: %ld, over %ld ticks, the last at tick %ld; pool blocks %ld\n",
+      PlayFrom != nullptr? " (with the replay's keyframes)": "", RewindSecs > 0? " (with the rewind buffer's)": "",
+      TickAllocs, AllocTicks, LastAllocTick, Machine.GetAllocs()
+   );
+   return 0;
+}
@@ -0,0 +1,41 @@
+## Asteroid Style Game, QT-based makefile for the headless simulation driver
+## (c) 2021 Darth Spectra (Lydia Marie Williamson)
+
+## A command-line program that runs the game engine with no window or sound, for profiling and soak-testing.
+## Build Engine.pro first.
+## See Asteroid.pro for notes on the QMake variables.
+
+## Configuration
+## Setup:
+TEMPLATE = app
+CONFIG += console warn_on release
+CONFIG -= qt app_bundle
+
+## Paths:
+TARGET = AsteroidSim
+DESTDIR = .
+INCLUDEPATH = .
+MAKEFILE = Makefile.Simulate
+
+## Defines:
+win32:DEFINES *= WINDOWS WIN32 UNICODE NO_DEBUG
+#debug:DEFINES *= _DEBUG
+## Make with "qmake CONFIG+=profile" to compile in the profiler (Profile.h), for the engine and the programs alike.
+profile:DEFINES *= PROFILE
+
+## Libraries:
+LIBS += -L. -lAsteroidEngine
+unix:LIBS += -lpthread # For the trace recorder's flusher thread and the simulation thread (Sim.h).
+win32-msvc*:PRE_TARGETDEPS += AsteroidEngine.lib
+else:PRE_TARGETDEPS += libAsteroidEngine.a
+
+## Objects and Temp files:
+debug:OBJECTS_DIR = Temp
+release:OBJECTS_DIR = Temp
+
+## Header Files:
+HEADERS += Allocs.h
+
+## Source Files:
+SOURCES += Simulate.cpp
+SOURCES += Allocs.cpp
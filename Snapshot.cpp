@@ -0,0 +1,82 @@
+// Asteroid Style Game: The engine's snapshots, for saving and restoring the whole state of a game at once.
+// Copyright (c) 2021 Darth Spectra
+#include <stdio.h>
+#include "Snapshot.h"
+#include "Engine.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// The engine's int columns (the particles' expiry ticks) are copied as they are.
+static_assert(sizeof(int) == sizeof(int32_t), "Snapshots take an int to be 32 bits.");
+
+// Round N up to a multiple of 8.
+static size_t Align8(size_t N) { return (N + 7)&~(size_t)7; }
+
+// Lay out a snapshot of Objs objects, Handles handle table entries and Sparks particles.
+SnapLayout::SnapLayout(size_t Objs, size_t Handles, size_t Sparks) {
+   size_t At = Align8(sizeof(SnapHeadT));
+   auto Take = [&At](size_t Bytes) { size_t Here = At; At = Align8(At + Bytes); return Here; };
+   X = Take(Objs*sizeof(double)), Y = Take(Objs*sizeof(double)), DX = Take(Objs*sizeof(double)), DY = Take(Objs*sizeof(double));
+   Radius = Take(Objs*sizeof(double)), Mass = Take(Objs*sizeof(double)), Kuyp = Take(Objs*sizeof(double));
+   this->Things = Take(Objs*sizeof(SnapThingT)), this->Handles = Take(Handles*sizeof(SnapHandleT));
+   Type = Take(Objs), Dead = Take(Objs);
+   SparkX = Take(Sparks*sizeof(double)), SparkY = Take(Sparks*sizeof(double)), SparkDX = Take(Sparks*sizeof(double)), SparkDY = Take(Sparks*sizeof(double));
+   SparkAngle = Take(Sparks*sizeof(double)), SparkTwist = Take(Sparks*sizeof(double)), SparkRadius = Take(Sparks*sizeof(double));
+   SparkExpire = Take(Sparks*sizeof(int32_t)), SparkType = Take(Sparks), SparkShape = Take(Sparks);
+   Bytes = At;
+}
+
+// The header of the snapshot in the Size bytes at Buf, if it is a well-formed snapshot of this version, that fits in them; else nullptr.
+// Only the header is looked at: the sections' offsets all follow from its counts, which are checked against the size that it gives.
+const SnapHeadT *Asteroid::SnapHead(const void *Buf, size_t Size) {
+   if (Buf == nullptr || ((uintptr_t)Buf&7) != 0 || Size < sizeof(SnapHeadT)) return nullptr;
+   const SnapHeadT *H = static_cast<const SnapHeadT *>(Buf);
+   if (H->Magic != SnapMagic || H->Version != SnapVersion || H->Order != SnapOrder) return nullptr;
+   if (H->HeadBytes != sizeof(SnapHeadT) || H->ThingBytes != sizeof(SnapThingT) || H->HandleBytes != sizeof(SnapHandleT) || H->TypeCount != TypeN)
+      return nullptr;
+   if (H->Sparks > (uint32_t)MaxParticles || H->SparkHead >= (uint32_t)MaxParticles || H->Objs > H->Handles) return nullptr;
+   if (H->Bytes > Size || H->Bytes != SnapLayout(H->Objs, H->Handles, H->Sparks).Bytes) return nullptr;
+   return H;
+}
+
+// class Snapshot: public methods
+// ──────────────────────────────
+// Make a new, empty, Snapshot object.
+Snapshot::Snapshot(): _Bytes(0) { }
+
+// Take a snapshot of the engine E, in place of the one held.
+bool Snapshot::Take(const Engine &E) {
+   size_t Bytes = E.SaveSize();
+   if (_Data.size() < Bytes/8) _Data.resize(Bytes/8);
+   _Bytes = E.Save(_Data.data(), 8*_Data.size());
+   return _Bytes > 0;
+}
+
+// Restore the engine E to the snapshot held, and tell whether it was a good one.
+bool Snapshot::Give(Engine &E) const { return _Bytes > 0 && E.Restore(_Data.data(), _Bytes); }
+
+// Write the snapshot out to the file at Path, and tell whether it was written.
+bool Snapshot::Write(const char *Path) const {
+   if (_Bytes == 0) return false;
+   FILE *ExF = fopen(Path, "wb"); if (ExF == nullptr) return false;
+   bool Ok = fwrite(_Data.data(), 1, _Bytes, ExF) == _Bytes;
+   return fclose(ExF) == 0 && Ok;
+}
+
+// Read a snapshot in from the file at Path, and tell whether it is a well-formed one.
+bool Snapshot::Read(const char *Path) {
+   _Bytes = 0;
+   FILE *InF = fopen(Path, "rb"); if (InF == nullptr) return false;
+   fseek(InF, 0, SEEK_END); long Size = ftell(InF); fseek(InF, 0, SEEK_SET);
+   if (Size > 0) {
+      _Data.resize((Size + 7)/8);
+      if (fread(_Data.data(), 1, Size, InF) == (size_t)Size && SnapHead(_Data.data(), Size) != nullptr) _Bytes = Size;
+   }
+   fclose(InF);
+   return _Bytes > 0;
+}
+
+// The snapshot's bytes, and their number (0, if there is none).
+const void *Snapshot::Data() const { return _Data.data(); }
+size_t Snapshot::Size() const { return _Bytes; }
@@ -0,0 +1,84 @@
+#ifndef OnceOnlySnapshot_h
+#define OnceOnlySnapshot_h
+
+// Asteroid Style Game: The engine's snapshots, for saving and restoring the whole state of a game at once.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Objects.h"
+
+namespace Asteroid {
+class Engine;
+
+// The snapshot format version, its magic number ("AstS", as a little-endian word) and the byte-order mark.
+const uint32_t SnapVersion = 1, SnapMagic = 0x53747341, SnapOrder = 0x01020304;
+
+// The snapshot layout
+// ───────────────────
+// A snapshot is one flat block, laid out the way that the engine holds its state, so that saving and restoring it is mostly block copies:
+// ∙	the header, with the engine's scalar state and the number of rows in each of the sections that follow;
+// ∙	the object roster, column by column, as in the engine's store (Store.h);
+// ∙	the objects' cold state, one fixed-size record each, in roster order;
+// ∙	the handle table, with each object given by its row;
+// ∙	the particle ring, column by column, as in the particle system (Particles.h).
+// Every section starts on an 8-byte boundary, at an offset that follows from the counts alone (SnapLayout),
+// so that a snapshot may be used in place, even straight from a file mapped into memory,
+// and it is validated from its header alone: the magic number, version, byte order, record sizes and total size (SnapHead()).
+// The numbers are in the byte order and floating-point format of the machine that wrote them, which is all that the byte-order mark lets through.
+struct SnapHeadT {
+   uint32_t Magic, Version, Order, Bytes; // Bytes: the size of the whole snapshot.
+   uint32_t HeadBytes, ThingBytes, HandleBytes, TypeCount; // The record sizes and the number of object types, which tie a snapshot to this layout.
+   uint32_t Objs, Handles, Sparks, SparkHead; // The section counts, and where the particle ring adds next.
+   uint64_t Rand[4];
+   double Level;
+   int32_t Ticks, Lives, InitRocks, Score, ExScore, HiScore, Xs, Ys;
+   int32_t NewLifeWait, EndDemoMark, EndGameMark, AlienCap;
+   int32_t FreeHandle, ShipIx; uint32_t Gen, ShipGen;
+   int32_t Census[TypeN], PeakCensus[TypeN];
+   int32_t SparkNow, SparkLive, SparkCount[TypeN];
+   uint8_t Active, Spare[3]; // Spare: once the sound flags, which are now events (Events.h), and left at 0.
+};
+
+// The cold state of an object; the ship's and the label's own fields are left at 0 for the other types.
+struct SnapThingT {
+   int32_t Ix; uint32_t Gen; // The object's handle.
+   double Twist, Angle, TurnAngle, TurnX, TurnY;
+   int32_t Shape, Ticks, Now, Pts;
+   char Caption[MaxCaption];
+   int32_t Orient, Spin, FireCharge, Life;
+   uint8_t Pushing, Firing, FireLock, JustFired;
+};
+
+// An entry of the handle table: the row of its object, or -1 for a free entry, which links to the Next one.
+struct SnapHandleT { int32_t Row, Next; uint32_t Gen; };
+
+// The offsets of the sections of a snapshot of Objs objects, Handles handle table entries and Sparks particles, and its size.
+struct SnapLayout {
+   size_t X, Y, DX, DY, Radius, Mass, Kuyp, Things, Handles, Type, Dead;
+   size_t SparkX, SparkY, SparkDX, SparkDY, SparkAngle, SparkTwist, SparkRadius, SparkExpire, SparkType, SparkShape;
+   size_t Bytes;
+   SnapLayout(size_t Objs, size_t Handles, size_t Sparks);
+};
+
+// The header of the snapshot in the Size bytes at Buf, if it is a well-formed snapshot of this version, that fits in them; else nullptr.
+const SnapHeadT *SnapHead(const void *Buf, size_t Size);
+
+// A snapshot, held in memory.
+// Its buffer is kept from one snapshot to the next, so that, once it has grown to fit, taking more snapshots never touches the heap.
+class Snapshot {
+private:
+   std::vector<uint64_t> _Data; // In 8-byte words, to keep the sections aligned.
+   size_t _Bytes;
+public:
+   Snapshot();
+   bool Take(const Engine &E);
+   bool Give(Engine &E) const;
+   bool Write(const char *Path) const;
+   bool Read(const char *Path);
+   const void *Data() const;
+   size_t Size() const;
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,38 @@
+// Asteroid Style Game: The column store for the hot data of the engine's objects.
+// Copyright (c) 2021 Darth Spectra
+#include "Store.h"
+#include "Objects.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// class Store: public methods
+// ───────────────────────────
+// Set aside room for N rows.
+void Store::Reserve(size_t N) {
+   X.reserve(N), Y.reserve(N), DX.reserve(N), DY.reserve(N), Radius.reserve(N), Mass.reserve(N);
+   Type.reserve(N), Kuyp.reserve(N), Dead.reserve(N), Obj.reserve(N);
+}
+
+// Add a row for Obj, at rest at the origin, and return its number.
+size_t Store::Add(Thing *Obj) {
+   X.push_back(0.0), Y.push_back(0.0), DX.push_back(0.0), DY.push_back(0.0), Radius.push_back(0.0), Mass.push_back(0.0);
+   Type.push_back(NoOT), Kuyp.push_back(0.0), Dead.push_back(0), this->Obj.push_back(Obj);
+   return this->Obj.size() - 1;
+}
+
+// Move row From to row To (To <= From), overwriting what was there; the object is told its new row.
+void Store::Move(size_t From, size_t To) {
+   X[To] = X[From], Y[To] = Y[From], DX[To] = DX[From], DY[To] = DY[From], Radius[To] = Radius[From], Mass[To] = Mass[From];
+   Type[To] = Type[From], Kuyp[To] = Kuyp[From], Dead[To] = Dead[From], Obj[To] = Obj[From];
+   Obj[To]->_Row = To;
+}
+
+// Cut the store down to its first N rows.
+void Store::Resize(size_t N) {
+   X.resize(N), Y.resize(N), DX.resize(N), DY.resize(N), Radius.resize(N), Mass.resize(N);
+   Type.resize(N), Kuyp.resize(N), Dead.resize(N), Obj.resize(N);
+}
+
+// Remove all the rows.
+void Store::Clear() { Resize(0); }
@@ -0,0 +1,35 @@
+#ifndef OnceOnlyStore_h
+#define OnceOnlyStore_h
+
+// Asteroid Style Game: The column store for the hot data of the engine's objects.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <vector>
+
+namespace Asteroid {
+class Thing;
+
+// The object store
+// ────────────────
+// Each object has a row in the store, which holds the data that the engine's loops go through on every tick:
+// position (X, Y), velocity (DX, DY), collision radius, mass, type, the dead flag and the Kuypier mask.
+// The mask is a double, 1 for objects that may roam the Kuypier region and 0 for those held to the screen, so that the motion kernels can use it directly.
+// These are kept in separate arrays, column by column, so that a loop over all the objects streams through memory,
+// touching only the columns it needs.
+// Everything else about an object (its behavior, shape, caption and font) is cold, and is kept in the object itself, which is in column Obj.
+// The rows are in roster order; removing rows closes up the gaps without reordering the rest.
+class Store {
+public:
+   std::vector<double> X, Y, DX, DY, Radius, Mass, Kuyp;
+   std::vector<unsigned char> Type, Dead;
+   std::vector<Thing *> Obj;
+   size_t Size() const { return Obj.size(); }
+   void Reserve(size_t N);
+   size_t Add(Thing *Obj);
+   void Move(size_t From, size_t To);
+   void Resize(size_t N);
+   void Clear();
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,83 @@
+#ifndef OnceOnlyStream_h
+#define OnceOnlyStream_h
+
+// Asteroid Style Game: A lock-free broadcast stream, for passing items from one thread to several others, each at its own pace.
+// Copyright (c) 2021 Darth Spectra
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+namespace Asteroid {
+// The single-producer, multiple-consumer stream
+// ─────────────────────────────────────────────
+// A ring of N items (N a power of 2), with one thread pushing items in and up to R readers each taking every one of them out, in order,
+// neither side ever waiting on the other. The producer never looks at the readers: it always writes the next item in, over the oldest,
+// so a reader that falls behind never holds up the producer, nor makes any other reader lose an item.
+// A reader that falls more than N items behind is lapped: it loses the items written over, skips on to the oldest that are left, and counts those lost (Lost()).
+// Each slot is a sequence lock: its sequence number is made odd while the producer writes the item into it, and then even, marked with the item's number,
+// and a reader keeps its copy of the item only if the slot's number was the item's both before and after it read it.
+// The items are copied in and out word by word, through atomics, so that a read racing with a write is never a data race; T must be trivially copyable.
+// As in Queue.h, the head and each reader's tail are padded out onto cache lines of their own, and each reader keeps the last head that it has seen.
+template <typename T, size_t N, size_t R> class Stream {
+   static_assert(N > 0 && (N&(N - 1)) == 0, "The stream's size must be a power of 2.");
+   static_assert(std::is_trivially_copyable<T>::value, "The stream's items must be trivially copyable.");
+private:
+   static const size_t Words = (sizeof(T) + 7)/8;
+   struct SlotT { std::atomic<size_t> Seq; std::atomic<uint64_t> Word[Words]; }; // Seq: 2n + 1, while item n is written in, then 2n + 2.
+   struct ReaderT { char Pad[64]; size_t Tail, HeadSeen; long Lost; };
+   SlotT _Ring[N];
+   char _Pad0[64]; std::atomic<size_t> _Head; // The producer's.
+   ReaderT _Readers[R]; // Each reader's own.
+   char _Pad1[64];
+public:
+   Stream(): _Head(0) {
+      for (size_t n = 0; n < N; n++) {
+         _Ring[n].Seq.store(0, std::memory_order_relaxed);
+         for (size_t w = 0; w < Words; w++) _Ring[n].Word[w].store(0, std::memory_order_relaxed);
+      }
+      for (size_t r = 0; r < R; r++) _Readers[r].Tail = 0, _Readers[r].HeadSeen = 0, _Readers[r].Lost = 0;
+   }
+// Attach the reader Rd, to take every item pushed from now on (on the reader's thread, before it takes any items, or before the producer starts).
+   void Attach(size_t Rd) {
+      ReaderT &Re = _Readers[Rd];
+      Re.Tail = Re.HeadSeen = _Head.load(std::memory_order_acquire), Re.Lost = 0;
+   }
+// Push Item in, over the oldest item, if the ring is full (on the producer's thread only).
+   void Push(const T &Item) {
+      size_t Head = _Head.load(std::memory_order_relaxed);
+      SlotT &S = _Ring[Head&(N - 1)];
+      uint64_t W[Words] = { 0 }; memcpy(W, &Item, sizeof(T));
+      S.Seq.store(2*Head + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for (size_t w = 0; w < Words; w++) S.Word[w].store(W[w], std::memory_order_relaxed);
+      S.Seq.store(2*Head + 2, std::memory_order_release);
+      _Head.store(Head + 1, std::memory_order_release);
+   }
+// Take the reader Rd's oldest item out into Item, or tell that it has taken them all (on the reader's thread only).
+// If the reader has been lapped, the items written over are skipped, and counted as lost.
+   bool Pop(size_t Rd, T &Item) {
+      ReaderT &Re = _Readers[Rd];
+      while (true) {
+         size_t Tail = Re.Tail;
+         if (Tail == Re.HeadSeen && Tail == (Re.HeadSeen = _Head.load(std::memory_order_acquire))) return false;
+         const SlotT &S = _Ring[Tail&(N - 1)];
+         size_t Seq = 2*Tail + 2;
+         if (S.Seq.load(std::memory_order_acquire) == Seq) {
+            uint64_t W[Words];
+            for (size_t w = 0; w < Words; w++) W[w] = S.Word[w].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (S.Seq.load(std::memory_order_relaxed) == Seq) { memcpy(&Item, W, sizeof(T)), Re.Tail = Tail + 1; return true; }
+         }
+      // Lapped: skip on to the oldest item that the producer cannot yet be writing over.
+         size_t Head = Re.HeadSeen = _Head.load(std::memory_order_acquire), Oldest = Head - N + 1;
+         Re.Lost += (long)(Oldest - Tail), Re.Tail = Oldest;
+      }
+   }
+// The number of items that the reader Rd has lost, by being lapped, since it was attached (on the reader's thread only).
+   long Lost(size_t Rd) const { return _Readers[Rd].Lost; }
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly
@@ -0,0 +1,201 @@
+// Asteroid Style Game: The trace recorder, which writes the engine's and the game's phases out as a Chrome trace-event file.
+// Copyright (c) 2021 Darth Spectra
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+using namespace std;
+using namespace Asteroid;
+
+// The event rings
+// ───────────────
+// One event: a span, from T0 for Dur nanoseconds, or a counter's Value at T0.
+struct TraceEvent {
+   const char *Name; char Kind;
+   uint64_t T0, Dur; double Value;
+};
+
+// A thread's ring of events: its thread alone moves the head, and the flusher alone moves the tail.
+// The head and tail are padded out onto cache lines of their own, so that the two threads do not contend for them,
+// and the thread only looks at the tail when the last tail it saw would leave the ring full.
+// A ring is made only when a thread records its first event, while tracing is on; it is handed back when the thread exits,
+// and used again, once it has been drained, by the next thread that needs one, so there are never more rings than threads that have traced at once.
+struct TraceRingT {
+   TraceEvent Ev[TraceRing];
+   char Pad0[64]; atomic<size_t> Head; size_t TailSeen;
+   char Pad1[64]; atomic<size_t> Tail;
+   char Pad2[64];
+   int Tid; const char *Name; bool Named, Held;
+   atomic<long> Dropped;
+   TraceRingT(): Head(0), TailSeen(0), Tail(0), Tid(0), Name(nullptr), Named(false), Held(false), Dropped(0) { }
+};
+
+static mutex RingLock; // Held to add, take or hand back a ring, or to go through them all; never by a thread recording an event into its own ring.
+static vector<TraceRingT *> Rings;
+static int Tids = 0; // The last thread number given out in the trace.
+
+// The calling thread's ring, if it has one, which is handed back when the thread exits; and the name that it was given, if any.
+struct RingHoldT {
+   TraceRingT *Ring;
+   ~RingHoldT() {
+      if (Ring == nullptr) return;
+      lock_guard<mutex> Lock(RingLock);
+      Ring->Held = false, Ring = nullptr;
+   }
+};
+static thread_local RingHoldT MyRing = { nullptr };
+static thread_local const char *MyName = nullptr;
+
+// The trace file, the flusher thread, and the time the trace started, by the steady clock, in nanoseconds.
+static FILE *TraceFile = nullptr;
+static thread Flusher;
+static atomic<bool> Flushing(false);
+static uint64_t TraceBase = 0;
+static bool FirstEvent = true;
+
+// The calling thread's ring: taken, the first time, from those handed back and drained, or else made anew, and given a new thread number.
+static TraceRingT *Mine() {
+   if (MyRing.Ring == nullptr) {
+      lock_guard<mutex> Lock(RingLock);
+      TraceRingT *R = nullptr;
+      for (size_t r = 0; r < Rings.size() && R == nullptr; r++)
+         if (!Rings[r]->Held && Rings[r]->Tail.load(memory_order_relaxed) == Rings[r]->Head.load(memory_order_relaxed)) R = Rings[r];
+      if (R == nullptr) R = new TraceRingT(), Rings.push_back(R);
+      R->Held = true, R->Tid = ++Tids, R->Name = MyName, R->Named = false, R->TailSeen = R->Tail.load(memory_order_relaxed);
+      MyRing.Ring = R;
+   }
+   return MyRing.Ring;
+}
+
+// Record an event in the calling thread's ring, or drop it, if the ring is full; a thread takes its ring only once tracing is on.
+static void Push(const TraceEvent &E) {
+   if (MyRing.Ring == nullptr && !Trace::On()) return;
+   TraceRingT *R = Mine();
+   size_t H = R->Head.load(memory_order_relaxed);
+   if (H - R->TailSeen >= (size_t)TraceRing && H - (R->TailSeen = R->Tail.load(memory_order_acquire)) >= (size_t)TraceRing) {
+      R->Dropped.fetch_add(1, memory_order_relaxed); return;
+   }
+   R->Ev[H%TraceRing] = E, R->Head.store(H + 1, memory_order_release);
+}
+
+// Append the string S to the buffer at B, and return the end.
+static char *Put(char *B, const char *S) {
+   while (*S != '\0') *B++ = *S++;
+   return B;
+}
+
+// Append the number N to the buffer at B, and return the end; with a decimal point before the last Places digits, if Places > 0.
+static char *PutN(char *B, uint64_t N, int Places = 0) {
+   char Digits[24]; int D = 0;
+   do Digits[D++] = '0' + N%10, N /= 10; while (N > 0 || D <= Places);
+   while (D > 0) { *B++ = Digits[--D]; if (D == Places && D > 0) *B++ = '.'; }
+   return B;
+}
+
+// Write one event out, in the trace-event format; the times are in microseconds from the start of the trace.
+// The flusher writes out every event that the engine records, so this is done by hand, rather than with the slower fprintf().
+static void Write(const TraceEvent &E, int Tid) {
+   char Buf[256], *B = Buf;
+   B = Put(B, FirstEvent? "\n{\"name\":\"": ",\n{\"name\":\""), FirstEvent = false;
+   B = Put(B, E.Name), B = Put(B, E.Kind == 'X'? "\",\"ph\":\"X\",\"ts\":": "\",\"ph\":\"C\",\"ts\":");
+   B = PutN(B, E.T0 > TraceBase? E.T0 - TraceBase: 0, 3);
+   if (E.Kind == 'X') B = Put(B, ",\"dur\":"), B = PutN(B, E.Dur, 3);
+   B = Put(B, ",\"pid\":1,\"tid\":"), B = PutN(B, Tid);
+   if (E.Kind != 'X') B += snprintf(B, Buf + sizeof Buf - B, ",\"args\":{\"%s\":%.6g}", E.Name, E.Value);
+   *B++ = '}';
+   fwrite(Buf, 1, B - Buf, TraceFile);
+}
+
+// Drain every ring into the trace file, and tell how many events there were.
+static size_t Drain() {
+   lock_guard<mutex> Lock(RingLock);
+   size_t N = 0;
+   for (size_t r = 0; r < Rings.size(); r++) {
+      TraceRingT *R = Rings[r];
+      if (R->Name != nullptr && !R->Named) {
+         fputs(FirstEvent? "\n": ",\n", TraceFile), FirstEvent = false;
+         fprintf(TraceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", R->Tid, R->Name);
+         R->Named = true;
+      }
+      size_t T = R->Tail.load(memory_order_relaxed), H = R->Head.load(memory_order_acquire);
+      for (N += H - T; T < H; T++) Write(R->Ev[T%TraceRing], R->Tid);
+      R->Tail.store(H, memory_order_release);
+   }
+   return N;
+}
+
+// The flusher thread: drain the rings until the trace is stopped, as fast as the events come in, resting only when they stop.
+static void Flush() {
+   while (Flushing.load(memory_order_acquire))
+      if (Drain() == 0) this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+// class Trace: public methods
+// ───────────────────────────
+atomic<bool> Trace::_On(false);
+
+// Start tracing into the file at Path, and tell whether it could be opened.
+// Any events left over from an earlier trace are dropped.
+// The calling thread's ring is taken here, so that its first traced event will not have to.
+bool Trace::Start(const char *Path) {
+   if (On()) Stop();
+   TraceFile = fopen(Path, "w"); if (TraceFile == nullptr) return false;
+   fputs("{\"traceEvents\":[", TraceFile), FirstEvent = true;
+   {
+      lock_guard<mutex> Lock(RingLock);
+      for (size_t r = 0; r < Rings.size(); r++)
+         Rings[r]->Tail.store(Rings[r]->Head.load(memory_order_acquire), memory_order_release), Rings[r]->Named = false, Rings[r]->Dropped.store(0);
+   }
+   Mine();
+   TraceBase = Now();
+   Flushing.store(true, memory_order_release), Flusher = thread(Flush);
+   _On.store(true, memory_order_release);
+   return true;
+}
+
+// Stop tracing: write out all the events recorded so far, and close the file.
+void Trace::Stop() {
+   if (!On()) return;
+   _On.store(false, memory_order_release);
+   Flushing.store(false, memory_order_release), Flusher.join();
+   Drain();
+   fprintf(TraceFile, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%ld}}\n", Dropped());
+   fclose(TraceFile), TraceFile = nullptr;
+}
+
+// The steady clock, in nanoseconds.
+uint64_t Trace::Now() {
+   return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Name the calling thread in the trace; Name must be a string that lives as long as the program.
+// The name is simply noted, until the thread's first traced event; so, with tracing off, no ring is taken for it.
+void Trace::NameThread(const char *Name) {
+   MyName = Name;
+   if (MyRing.Ring == nullptr) return;
+   lock_guard<mutex> Lock(RingLock);
+   MyRing.Ring->Name = Name, MyRing.Ring->Named = false;
+}
+
+// Record a span for probe P, from T0 to T1, by Now().
+void Trace::Span(ProbeT P, uint64_t T0, uint64_t T1) {
+   TraceEvent E = { Profile::Name(P), 'X', T0, T1 - T0, 0.0 };
+   Push(E);
+}
+
+// Record the value of the counter Name.
+void Trace::Count(const char *Name, double Value) {
+   TraceEvent E = { Name, 'C', Now(), 0, Value };
+   Push(E);
+}
+
+// The number of events dropped, for want of room in the rings, since tracing was started.
+long Trace::Dropped() {
+   lock_guard<mutex> Lock(RingLock);
+   long N = 0;
+   for (size_t r = 0; r < Rings.size(); r++) N += Rings[r]->Dropped.load(memory_order_relaxed);
+   return N;
+}
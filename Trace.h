@@ -0,0 +1,52 @@
+#ifndef OnceOnlyTrace_h
+#define OnceOnlyTrace_h
+
+// Asteroid Style Game: The trace recorder, which writes the engine's and the game's phases out as a Chrome trace-event file.
+// Copyright (c) 2021 Darth Spectra
+#include <stdint.h>
+#include <atomic>
+#include "Profile.h"
+
+namespace Asteroid {
+// The number of events that each thread may have waiting to be written out; any more than that are dropped, and counted.
+const int TraceRing = 1 << 16;
+
+// The trace recorder
+// ──────────────────
+// Tracing is switched on at run time, by Start(), and writes a trace-event JSON file that chrome://tracing and Perfetto can open:
+// a span ("ph":"X") for each traced scope, and a counter ("ph":"C") for each traced value, stamped by the steady clock.
+// Each thread records its events into a ring of its own, which only it writes to, without locks or heap allocations;
+// a flusher thread drains the rings and does the formatting and writing, off the hot path, so that, with a core to spare, the trace hardly distorts what it measures.
+// When tracing is off, a traced scope costs one test of the switch.
+// The probes are placed with the Traced() and TraceCount() macros; the spans are named after the profiler's probes (Profile.h).
+class Trace {
+private:
+   static std::atomic<bool> _On;
+public:
+   static bool Start(const char *Path);
+   static void Stop();
+   static bool On() { return _On.load(std::memory_order_relaxed); }
+   static uint64_t Now();
+   static void NameThread(const char *Name);
+   static void Span(ProbeT P, uint64_t T0, uint64_t T1);
+   static void Count(const char *Name, double Value);
+   static long Dropped();
+};
+
+// Trace the rest of the enclosing scope, as a span for probe P.
+class TraceSpan {
+private:
+   ProbeT _Probe;
+   uint64_t _T0;
+public:
+   explicit TraceSpan(ProbeT P): _Probe(Trace::On()? P: ProbeN), _T0(_Probe != ProbeN? Trace::Now(): 0) { }
+   ~TraceSpan() { if (_Probe != ProbeN) Trace::Span(_Probe, _T0, Trace::Now()); }
+};
+} // end of namespace Asteroid
+
+// Traced(P): trace the rest of the scope as a span for probe P (once per scope).
+// TraceCount(Name, Value): record Value for the counter Name, which must be a string that lives as long as the program.
+#define Traced(P)		Asteroid::TraceSpan TracedSpan(P)
+#define TraceCount(Name, Value)	(Asteroid::Trace::On()? Asteroid::Trace::Count((Name), (double)(Value)): (void)0)
+
+#endif // OnceOnly
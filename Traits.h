@@ -0,0 +1,78 @@
+#ifndef OnceOnlyTraits_h
+#define OnceOnlyTraits_h
+
+// Asteroid Style Game: The compile-time traits of the object types, and which types can interact.
+// Copyright (c) 2021 Darth Spectra
+#include "Objects.h"
+
+namespace Asteroid {
+// The type traits
+// ───────────────
+// These are taken from the TypeMass, TypeRocky and TypeKuypier constants of the object classes,
+// so the engine can look them up by the type in its store, rather than asking each object through a virtual call.
+// Debris, sparks and thrust are not objects, but particles (Particles.h): they have no mass here, and so never enter the collision tests,
+// although they roam the Kuypier region, as the particle system's wrap does.
+constexpr double MassOf(int T) {
+   return
+      T == BoulderOT? Boulder::TypeMass: T == StoneOT? Stone::TypeMass: T == PebbleOT? Pebble::TypeMass:
+      T == ShipOT? Ship::TypeMass: T == AlienOT? Alien::TypeMass: T == LanceOT? Lance::TypeMass:
+      T == LabelOT? Label::TypeMass: 0.0;
+}
+
+constexpr bool RockyOf(int T) { return T == BoulderOT || T == StoneOT || T == PebbleOT? Rock::TypeRocky: false; }
+
+constexpr bool KuypierOf(int T) {
+   return
+      T == BoulderOT || T == StoneOT || T == PebbleOT? Rock::TypeKuypier:
+      T == ShipOT? Ship::TypeKuypier: T == AlienOT? Alien::TypeKuypier: T == LanceOT? Lance::TypeKuypier:
+      T == DebrisOT || T == SparkOT || T == ThrustOT? true: T == LabelOT? Label::TypeKuypier: false;
+}
+
+// Does the type take part in collisions at all?
+// Objects with zero mass are transparent: they are never tested for collisions, and so never rebound or die from one.
+constexpr bool SolidOf(int T) { return MassOf(T) > 0.0; }
+
+// Could a collision with a type-B object ever be fatal to a type-A object; that is, could A.Lethal(B) ever be true?
+// This follows the Lethal() methods, leaving out the conditions that are only known at run time (age, place, speed and chance).
+// It is only ever false where Lethal() is certain to be false without drawing on the random number generator,
+// so skipping the call leaves the game unchanged.
+constexpr bool KillsOf(int A, int B) {
+   return
+      !SolidOf(A) || !SolidOf(B)? false:
+   // Rocks die from lances, and from rocks (or anything) at least as heavy as themselves.
+      RockyOf(A)? B == LanceOT || MassOf(B) >= MassOf(A):
+   // The ship dies from anything heavier than itself.
+      A == ShipOT? MassOf(B) > MassOf(A):
+   // Aliens die from lances, and from anything heavier than themselves.
+      A == AlienOT? B == LanceOT || MassOf(B) > MassOf(A):
+   // Lances die on hitting anything.
+      A == LanceOT? true:
+      false;
+}
+
+// The lethality matrix, as a bit mask for each type A, with bit B set if KillsOf(A, B).
+constexpr unsigned KillMask(int A, int B = 0) { return B >= TypeN? 0U: (KillsOf(A, B)? 1U << B: 0U) | KillMask(A, B + 1); }
+
+struct TypeTraits {
+   double Mass;
+   bool Solid, Rocky, Kuypier;
+   unsigned Kills;
+};
+
+constexpr TypeTraits TraitsOf(int T) { return TypeTraits{ MassOf(T), SolidOf(T), RockyOf(T), KuypierOf(T), KillMask(T) }; }
+
+// The traits of each type, indexed by TypeT.
+constexpr TypeTraits Traits[TypeN] = {
+   TraitsOf(NoOT), TraitsOf(BoulderOT), TraitsOf(StoneOT), TraitsOf(PebbleOT), TraitsOf(ShipOT), TraitsOf(AlienOT),
+   TraitsOf(LanceOT), TraitsOf(DebrisOT), TraitsOf(SparkOT), TraitsOf(ThrustOT), TraitsOf(LabelOT)
+};
+
+// Could a collision with a type-B object ever be fatal to a type-A object?
+inline bool CanKill(int A, int B) { return (Traits[A].Kills >> B & 1U) != 0; }
+
+static_assert(!Traits[LabelOT].Solid && !Traits[ThrustOT].Solid && !Traits[DebrisOT].Solid, "Labels and particles are transparent.");
+static_assert(KillsOf(ShipOT, PebbleOT) && !KillsOf(ShipOT, DebrisOT) && !KillsOf(ShipOT, LanceOT), "The ship dies from anything heavier.");
+static_assert(KillsOf(StoneOT, StoneOT) && !KillsOf(BoulderOT, StoneOT), "Rocks die from rocks at least as heavy.");
+} // end of namespace Asteroid
+
+#endif // OnceOnly
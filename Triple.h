@@ -0,0 +1,46 @@
+#ifndef OnceOnlyTriple_h
+#define OnceOnlyTriple_h
+
+// Asteroid Style Game: A lock-free triple buffer, for handing the latest of a series of values from one thread to another.
+// Copyright (c) 2021 Darth Spectra
+#include <atomic>
+
+namespace Asteroid {
+// The triple buffer
+// ─────────────────
+// Three slots: the writer's back slot, which it fills in, the reader's front slot, which it reads from, and the middle slot, which is passed between them.
+// The writer publishes its back slot by swapping it with the middle one, flagged as fresh; the reader takes the middle slot,
+// if it is fresh, by swapping it with its front one. Neither side ever waits on the other, nor copies a value:
+// the writer may publish as often as it likes, and the reader always gets the latest value published, and keeps it unchanged for as long as it holds it.
+// A value that is published over before the reader takes it is handed back to the writer, which is told, so that it may carry anything over from it.
+template <typename T> class Triple {
+private:
+   static const unsigned Fresh = 4; // Flags the middle slot's index when the writer has published it and the reader has not yet taken it.
+   T _Slot[3];
+   char _Pad0[64]; std::atomic<unsigned> _Middle;
+   char _Pad1[64]; unsigned _Back; // The writer's.
+   char _Pad2[64]; unsigned _Front; // The reader's.
+   char _Pad3[64];
+public:
+   Triple(): _Middle(1), _Back(0), _Front(2) { }
+// The writer's slot, to fill in (on the writer's thread only).
+   T &Back() { return _Slot[_Back]; }
+// Publish the writer's slot; the writer then gets another one, which holds a value that is either older than the reader's or, if true is returned,
+// the one published before, which the reader never took (on the writer's thread only).
+   bool Publish() {
+      unsigned Old = _Middle.exchange(_Back | Fresh, std::memory_order_acq_rel);
+      _Back = Old&~Fresh;
+      return (Old&Fresh) != 0;
+   }
+// Take the latest value published, if there is a newer one than the reader holds, and tell whether there was (on the reader's thread only).
+   bool Fetch() {
+      if ((_Middle.load(std::memory_order_relaxed)&Fresh) == 0) return false;
+      _Front = _Middle.exchange(_Front, std::memory_order_acq_rel)&~Fresh;
+      return true;
+   }
+// The reader's slot (on the reader's thread only).
+   const T &Front() const { return _Slot[_Front]; }
+};
+} // end of namespace Asteroid
+
+#endif // OnceOnly